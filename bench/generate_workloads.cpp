@@ -0,0 +1,110 @@
+// Writes the arithmetic-, print- and string-heavy workloads of the runtime benchmark into a directory.
+// The generator is seeded with a fixed value and only uses std::mt19937 output directly, whose sequence the
+// standard pins down, so every build produces byte-identical workloads and the baseline stays comparable.
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+constexpr uint32_t WORKLOAD_SEED = 20260;
+
+constexpr int ARITHMETIC_STATEMENTS = 3000;
+constexpr int PRINT_GROUPS = 30000;
+constexpr int PRINT_VARIABLES = 50;
+constexpr int STRING_VARIABLES = 300;
+constexpr int STRING_WORDS = 120;
+constexpr int STRING_PRINTS = 99500;
+
+//* std::uniform_int_distribution is implementation-defined, plain modulo keeps the output identical across standard libraries
+int pick(std::mt19937 &rng, int lo, int hi) {
+    return lo + static_cast<int>(rng() % static_cast<uint32_t>(hi - lo + 1));
+}
+
+// chain of divisions over earlier results, so the generated C cannot fold it into constants
+void writeArithmetic(std::ostream &out, std::mt19937 &rng) {
+    out << "a0 = 1" << std::endl;
+    out << "a1 = 2" << std::endl;
+    out << "a2 = 3" << std::endl;
+    //* every value is drawn into its own variable, the evaluation order of function arguments is unspecified
+    for (int i = 3; i < ARITHMETIC_STATEMENTS; ++i) {
+        int first = pick(rng, 0, i - 1);
+        int factor = pick(rng, 2, 9);
+        int firstDivisor = pick(rng, 2, 9);
+        int second = pick(rng, 0, i - 1);
+        int secondDivisor = pick(rng, 2, 9);
+        int third = pick(rng, 0, i - 1);
+        int thirdDivisor = pick(rng, 2, 9);
+        int offset = pick(rng, 1, 99);
+        out << std::format("a{} = a{} * {} / {} + a{} / {} - a{} / {} + {}", i, first, factor, firstDivisor,
+                           second, secondDivisor, third, thirdDivisor, offset) << std::endl;
+    }
+    out << std::format("print a{}", ARITHMETIC_STATEMENTS - 1) << std::endl;
+}
+
+void writePrint(std::ostream &out, std::mt19937 &rng) {
+    for (int i = 0; i < PRINT_GROUPS; ++i) {
+        int variable = i % PRINT_VARIABLES;
+        int literal = pick(rng, 0, 99999);
+        int left = pick(rng, 0, 999);
+        int right = pick(rng, 0, 999);
+        int offset = pick(rng, 0, 999);
+        int value = pick(rng, 0, 999);
+        out << std::format("print {}", literal) << std::endl;
+        out << std::format("print {} * {} + {}", left, right, offset) << std::endl;
+        out << std::format("p{} = {}", variable, value) << std::endl;
+        out << std::format("print p{}", variable) << std::endl;
+    }
+}
+
+void writeStrings(std::ostream &out, std::mt19937 &rng) {
+    const char *words[] = { "eva", "rei", "asuka", "shinji", "misato", "kaworu", "gendo", "nerv", "seele", "unit" };
+    constexpr int wordCount = sizeof(words) / sizeof(words[0]);
+
+    for (int i = 0; i < STRING_VARIABLES; ++i) {
+        std::string text = words[pick(rng, 0, wordCount - 1)];
+        for (int word = 1; word < STRING_WORDS; ++word) {
+            text += ' ';
+            text += words[pick(rng, 0, wordCount - 1)];
+        }
+        out << std::format("s{} = \"{}\"", i, text) << std::endl;
+        out << std::format("print s{}", i) << std::endl;
+    }
+    for (int i = 0; i < STRING_PRINTS; ++i) {
+        out << std::format("print s{}", pick(rng, 0, STRING_VARIABLES - 1)) << std::endl;
+    }
+}
+
+bool writeWorkload(const std::filesystem::path &path, void (*write)(std::ostream &, std::mt19937 &), std::mt19937 &rng) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "[error]: Error writing workload: " << path.string() << std::endl;
+        return false;
+    }
+    write(file, rng);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cout << "Usage: reic-bench-workloads <output_dir>" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path outputDir = argv[1];
+    std::filesystem::create_directories(outputDir);
+
+    //* one generator per workload, so resizing one of them does not reshuffle the others
+    std::mt19937 arithmeticRng(WORKLOAD_SEED);
+    std::mt19937 printRng(WORKLOAD_SEED + 1);
+    std::mt19937 stringsRng(WORKLOAD_SEED + 2);
+    if (!writeWorkload(outputDir / "arithmetic.reic", writeArithmetic, arithmeticRng) ||
+        !writeWorkload(outputDir / "print.reic", writePrint, printRng) ||
+        !writeWorkload(outputDir / "strings.reic", writeStrings, stringsRng)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+// Compiles every workload through `reic --compile`, runs the produced binaries and compares
+// their median runtime and size, and the peak memory reic reported while compiling them, against a stored baseline.
+// Runtimes are the CPU time of one execution of the program itself, net of process start-up measured with an empty
+// generated program. Short programs are executed repeatedly per sample so that every sample spans a measurable time.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+// below this net runtime the numbers are mostly timer and scheduler noise, so only the size is compared
+constexpr double MIN_GATED_RUNTIME_MS = 0.02;
+
+// every sample repeats the program until it has used about this much CPU time, at most MAX_REPEATS times
+constexpr double SAMPLE_TARGET_MS = 50.0;
+constexpr int MAX_REPEATS = 1000;
+
+struct BenchResult {
+    double runtimeMs;
+    double runtimeLowerQuartileMs; // not stored in the baseline, only used to gate the current run
+    uintmax_t binarySize;
+    uintmax_t compilerPeakBytes;
+};
+
+void displayHelp() {
+    std::cout << "Usage: reic-runtime-bench --reic <path> --workloads <dir> --baseline <file> [--runs <n>] [--threshold <percent>] [--update-baseline]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --reic <path>          reic executable used to compile the workloads" << std::endl;
+    std::cout << "  --workloads <dir>      Directory containing the .reic workloads" << std::endl;
+    std::cout << "  --baseline <file>      Baseline to compare against, written if missing" << std::endl;
+    std::cout << "  --runs <n>             Samples per workload, the median is reported (default 20)" << std::endl;
+    std::cout << "  --threshold <percent>  Allowed slowdown or growth before flagging (default 10)" << std::endl;
+    std::cout << "  --update-baseline      Overwrite the baseline with this run's results" << std::endl;
+}
+
+std::map<std::string, BenchResult> readBaseline(const std::string &fileName) {
+    std::map<std::string, BenchResult> baseline;
+    std::ifstream file(fileName);
+    std::string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        BenchResult result;
+        if (fields >> name >> result.runtimeMs >> result.binarySize >> result.compilerPeakBytes) {
+            result.runtimeLowerQuartileMs = result.runtimeMs;
+            baseline[name] = result;
+        }
+    }
+    return baseline;
+}
+
+bool writeBaseline(const std::string &fileName, const std::map<std::string, BenchResult> &results) {
+    std::ofstream file(fileName);
+    if (!file) return false;
+    file << "# workload median_runtime_ms_without_startup binary_size_bytes compiler_peak_bytes" << std::endl;
+    for (const auto &[name, result] : results) {
+        file << std::format("{} {:.3f} {} {}", name, result.runtimeMs, result.binarySize, result.compilerPeakBytes) << std::endl;
+    }
+    return true;
+}
+
+// starts the program without a shell and reports the user + system time it used itself, which unlike wall time
+// does not include the time it spent waiting for the CPU; returns its exit status or -1
+int runProgram(const std::string &executable, double &cpuMs) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    char *args[] = { const_cast<char *>(executable.c_str()), nullptr };
+    pid_t pid;
+    int spawned = posix_spawn(&pid, executable.c_str(), &actions, nullptr, args, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawned != 0) return -1;
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) return -1;
+    cpuMs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// turns "12.34 MiB" as printed by reic --mem-report back into bytes
+uintmax_t parseBytes(double value, const std::string &unit) {
+    const char *units[] = { "B", "KiB", "MiB", "GiB" };
+    for (const char *name : units) {
+        if (unit == name) return static_cast<uintmax_t>(value);
+        value *= 1024.0;
+    }
+    return 0;
+}
+
+// compiles with --mem-report and returns the compiler's peak live memory from its "total" row
+bool compileWorkload(const std::string &reicPath, const std::string &source, const std::string &cFile, uintmax_t &peakBytes) {
+    //* the normal user-facing path, so codegen changes show up in the numbers
+    std::string command = std::format("\"{}\" \"{}\" --compile --no-cache --mem-report -o \"{}\"", reicPath, source, cFile);
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) return false;
+
+    std::string output;
+    char buffer[4096];
+    while (size_t read = fread(buffer, 1, sizeof(buffer), pipe)) {
+        output.append(buffer, read);
+    }
+    if (pclose(pipe) != 0) return false;
+
+    std::istringstream lines(output);
+    std::string line;
+    peakBytes = 0;
+    while (getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string phase, allocatedUnit, peakUnit;
+        size_t allocations;
+        double allocated, peak;
+        if (fields >> phase >> allocations >> allocated >> allocatedUnit >> peak >> peakUnit && phase == "total") {
+            peakBytes = parseBytes(peak, peakUnit);
+        }
+    }
+    return true;
+}
+
+// runs the program repeats times in a row and returns the CPU time per execution, -1 if any run failed
+double runRepeated(const std::string &executable, int repeats) {
+    double totalMs = 0;
+    for (int repeat = 0; repeat < repeats; ++repeat) {
+        double cpuMs = 0;
+        int status = runProgram(executable, cpuMs);
+        if (status != 0) {
+            std::cerr << std::format("[error]: {} exited with status {}", executable, status) << std::endl;
+            return -1;
+        }
+        totalMs += cpuMs;
+    }
+    return totalMs / repeats;
+}
+
+// number of executions per sample so that a sample spans about SAMPLE_TARGET_MS, 0 if the program failed
+int sampleRepeats(const std::string &executable) {
+    //* the warm-up run also sizes the samples, a single sub-millisecond run is below the rusage resolution
+    double warmupMs = runRepeated(executable, 1);
+    if (warmupMs < 0) return 0;
+    return std::clamp(static_cast<int>(SAMPLE_TARGET_MS / std::max(warmupMs, 0.01)), 1, MAX_REPEATS);
+}
+
+// median CPU time per execution net of the reference program, -1 if any run failed
+// the lower quartile of the samples is reported as well, it is what the regression check compares
+double measureRuntime(const std::string &executable, const std::string &reference, int runs, double &lowerQuartileMs) {
+    int repeats = sampleRepeats(executable);
+    int referenceRepeats = sampleRepeats(reference);
+    if (repeats == 0 || referenceRepeats == 0) return -1;
+
+    //* the reference is measured right next to every sample, so drifting CPU speed hits both sides of the difference alike
+    std::vector<double> times;
+    for (int run = 0; run < runs; ++run) {
+        double cpuMs = runRepeated(executable, repeats);
+        double referenceMs = runRepeated(reference, referenceRepeats);
+        if (cpuMs < 0 || referenceMs < 0) return -1;
+        times.push_back(cpuMs - referenceMs);
+    }
+    std::sort(times.begin(), times.end());
+    lowerQuartileMs = times[times.size() / 4];
+    return times[times.size() / 2];
+}
+
+std::string formatChange(double current, double baseline) {
+    if (baseline <= 0) return "n/a";
+    return std::format("{:+.1f}%", (current / baseline - 1.0) * 100.0);
+}
+
+int main(int argc, char *argv[]) {
+    std::string reicPath;
+    std::string workloadDir;
+    std::string baselineFileName;
+    int runs = 20;
+    double threshold = 10.0;
+    bool updateBaseline = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            displayHelp();
+            return 0;
+        } else if (arg == "--update-baseline") {
+            updateBaseline = true;
+        } else if (i + 1 < argc && arg == "--reic") {
+            reicPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--workloads") {
+            workloadDir = argv[++i];
+        } else if (i + 1 < argc && arg == "--baseline") {
+            baselineFileName = argv[++i];
+        } else if (i + 1 < argc && arg == "--runs") {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--threshold") {
+            threshold = std::atof(argv[++i]);
+        } else {
+            std::cerr << "[error]: Unknown option: " << arg << std::endl;
+            displayHelp();
+            return 1;
+        }
+    }
+
+    if (reicPath.empty() || workloadDir.empty() || baselineFileName.empty()) {
+        std::cerr << "[error]: --reic, --workloads and --baseline are required." << std::endl;
+        displayHelp();
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> workloads;
+    for (const auto &entry : std::filesystem::directory_iterator(workloadDir)) {
+        if (entry.path().extension() == ".reic") {
+            workloads.push_back(entry.path());
+        }
+    }
+    std::sort(workloads.begin(), workloads.end());
+    if (workloads.empty()) {
+        std::cerr << "[error]: No .reic workloads found in " << workloadDir << std::endl;
+        return 1;
+    }
+
+    auto buildDir = std::filesystem::temp_directory_path() / "reic-runtime-bench";
+    std::filesystem::create_directories(buildDir);
+
+    //* process start-up would otherwise dominate short workloads, so it is measured once and subtracted
+    std::string startupSource = (buildDir / "startup.reic").string();
+    std::ofstream(startupSource) << "x = 0" << std::endl;
+    std::string startupExecutable = (buildDir / "startup").string();
+    uintmax_t startupPeakBytes;
+    if (!compileWorkload(reicPath, startupSource, startupExecutable + ".c", startupPeakBytes)) {
+        std::cerr << "[error]: Failed to compile the start-up reference program" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, BenchResult> results;
+    for (const auto &workload : workloads) {
+        std::string name = workload.stem().string();
+        std::string cFile = (buildDir / (name + ".c")).string();
+        std::string executable = (buildDir / name).string();
+
+        uintmax_t compilerPeakBytes;
+        if (!compileWorkload(reicPath, workload.string(), cFile, compilerPeakBytes)) {
+            std::cerr << "[error]: Failed to compile workload: " << workload.string() << std::endl;
+            return 1;
+        }
+
+        double lowerQuartileMs = 0;
+        double runtimeMs = measureRuntime(executable, startupExecutable, runs, lowerQuartileMs);
+        if (runtimeMs < 0) {
+            std::cerr << "[error]: Workload failed to run: " << name << std::endl;
+            return 1;
+        }
+        results[name] = { std::max(0.0, runtimeMs), std::max(0.0, lowerQuartileMs), std::filesystem::file_size(executable), compilerPeakBytes };
+    }
+
+    auto baseline = readBaseline(baselineFileName);
+    bool regressed = false;
+
+    std::cout << std::format("{:<14}{:>14}{:>14}{:>10}{:>12}{:>12}{:>10}{:>14}{:>14}{:>10}", "workload", "runtime (ms)", "baseline", "change",
+                             "size (B)", "baseline", "change", "reic peak (B)", "baseline", "change") << std::endl;
+    for (const auto &[name, result] : results) {
+        auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << std::format("{:<14}{:>14.3f}{:>14}{:>10}{:>12}{:>12}{:>10}{:>14}{:>14}{:>10}", name, result.runtimeMs, "-", "new",
+                                     result.binarySize, "-", "new", result.compilerPeakBytes, "-", "new") << std::endl;
+            continue;
+        }
+
+        const BenchResult &base = it->second;
+        bool gated = base.runtimeMs >= MIN_GATED_RUNTIME_MS;
+        //* sub-millisecond workloads spread well beyond the threshold between samples, so a run only counts as
+        //* slower when even its faster quarter of samples is
+        bool slower = gated && result.runtimeLowerQuartileMs > base.runtimeMs * (1.0 + threshold / 100.0);
+        bool bigger = result.binarySize > base.binarySize * (1.0 + threshold / 100.0);
+        bool hungrier = result.compilerPeakBytes > base.compilerPeakBytes * (1.0 + threshold / 100.0);
+        std::cout << std::format("{:<14}{:>14.3f}{:>14.3f}{:>10}{:>12}{:>12}{:>10}{:>14}{:>14}{:>10}", name, result.runtimeMs, base.runtimeMs,
+                                 formatChange(result.runtimeMs, base.runtimeMs), result.binarySize, base.binarySize,
+                                 formatChange(result.binarySize, base.binarySize), result.compilerPeakBytes, base.compilerPeakBytes,
+                                 formatChange(result.compilerPeakBytes, base.compilerPeakBytes))
+                  << (slower || bigger || hungrier ? "  REGRESSION" : "") << (gated ? "" : "  (runtime too short to compare)") << std::endl;
+        regressed = regressed || slower || bigger || hungrier;
+    }
+
+    if (updateBaseline || baseline.empty()) {
+        if (!writeBaseline(baselineFileName, results)) {
+            std::cerr << "[error]: Error writing baseline: " << baselineFileName << std::endl;
+            return 1;
+        }
+        std::cout << "Baseline written to " << baselineFileName << std::endl;
+        return 0;
+    }
+
+    if (regressed) {
+        std::cerr << std::format("[error]: Runtime or size regressed by more than {:.0f}%.", threshold) << std::endl;
+        return 1;
+    }
+    return 0;
+}
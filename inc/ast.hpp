@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 enum class NodeType {
     STRING,
@@ -29,6 +30,7 @@ struct ASTNode {
     }
 
     NodeType type;
+    size_t lineNumber = 0; // source line the node starts on, 0 if unknown
 };
 
 struct StringNode : ASTNode {
@@ -55,15 +57,23 @@ struct KeywordNode : ASTNode {
     std::string name;
 };
 
+// a flat left-associative chain of same-precedence operations:
+// operands[0] ops[0] operands[1] ops[1] operands[2] ...
+// long machine-generated chains stay one level deep instead of becoming a left-deep tree
 struct BinaryOpNode : ASTNode {
-    BinaryOpNode(std::unique_ptr<ASTNode> l, std::string o, std::unique_ptr<ASTNode> r)
-        : left(std::move(l)), right(std::move(r)), op(o) {
+    BinaryOpNode(std::unique_ptr<ASTNode> l, std::string o, std::unique_ptr<ASTNode> r) {
         type = NodeType::BINARY_OP;
+        operands.push_back(std::move(l));
+        append(std::move(o), std::move(r));
     }
 
-    std::unique_ptr<ASTNode> left;
-    std::unique_ptr<ASTNode> right;
-    std::string op;
+    void append(std::string o, std::unique_ptr<ASTNode> r) {
+        ops.push_back(std::move(o));
+        operands.push_back(std::move(r));
+    }
+
+    std::vector<std::unique_ptr<ASTNode>> operands;
+    std::vector<std::string> ops;
 };
 
 struct AssignmentNode : ASTNode {
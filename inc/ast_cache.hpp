@@ -0,0 +1,72 @@
+#pragma once
+#ifndef AST_CACHE_HPP
+#define AST_CACHE_HPP
+
+#include "ast.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Binary AST format (native byte order, every section 4-byte aligned so the file can be mmapped):
+ *
+ *   ASTFileHeader
+ *   uint32_t       roots[rootCount]        indices of the top-level statements
+ *   ASTFileNode    nodes[nodeCount]        children always precede their parent
+ *   uint32_t       links[linkCount]        operand/operator lists of BINARY_OP chains
+ *   ASTFileString  strings[stringCount]    (offset, length) into the blob
+ *   char           blob[blobSize]
+ */
+constexpr char AST_FILE_MAGIC[8] = { 'R', 'E', 'I', 'C', 'A', 'S', 'T', '\0' };
+constexpr uint32_t AST_FILE_VERSION = 4;
+constexpr uint32_t AST_FILE_NONE = UINT32_MAX;
+
+struct ASTFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rootCount;
+    uint64_t sourceHash;
+    uint32_t nodeCount;
+    uint32_t stringCount;
+    uint32_t blobSize;
+    uint32_t sourceFile;    // string id of the source path, AST_FILE_NONE if unknown
+    uint32_t linkCount;
+    uint32_t reserved;
+};
+
+// STRING/IDENTIFIER/KEYWORD: a = string, NUMBER: a = value,
+// BINARY_OP: a = first link, b = operand count, ASSIGNMENT: a = variable string, b = value
+// a chain of n operands uses 2n - 1 links: operand, op string, operand, op string, ..., operand
+// fields a node type does not use are 0
+struct ASTFileNode {
+    uint32_t type;
+    uint32_t line;
+    uint32_t a;
+    uint32_t b;
+};
+
+struct ASTFileString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+// what an AST file records about the source it was parsed from
+struct ASTSourceInfo {
+    uint64_t hash;
+    std::string fileName;
+};
+
+class ASTCache {
+public:
+    static uint64_t hashSource(const std::string& content);
+    static std::string cachePathFor(const std::string& sourceFile);
+
+    static std::string serialize(const std::vector<std::unique_ptr<ASTNode>>& nodes, const ASTSourceInfo& source);
+    static bool deserialize(const std::string& data, std::vector<std::unique_ptr<ASTNode>>& nodes, ASTSourceInfo& source);
+
+    static bool save(const std::string& path, const std::vector<std::unique_ptr<ASTNode>>& nodes, const ASTSourceInfo& source);
+    static bool load(const std::string& path, std::vector<std::unique_ptr<ASTNode>>& nodes, ASTSourceInfo& source);
+};
+
+#endif // AST_CACHE_HPP
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <vector>
+
+// lock-free single producer / single consumer ring buffer, push blocks while full and pop while empty
+// closing it lets pop drain what is left, while push drops the item and returns false
+template <typename T>
+class BoundedQueue {
+public:
+    BoundedQueue(size_t capacity) : slots(capacity) {}
+
+    bool push(T&& item) {
+        size_t current = tail.load(std::memory_order_relaxed) & ~CLOSED;
+        size_t observed = head.load(std::memory_order_acquire);
+        while (!(observed & CLOSED) && current - observed == slots.size()) {
+            //* sleeps until the consumer moves head, closing sets a bit in head so it wakes up as well
+            head.wait(observed, std::memory_order_acquire);
+            observed = head.load(std::memory_order_acquire);
+        }
+        if (observed & CLOSED)
+            return false;
+        slots[current % slots.size()] = std::move(item);
+        tail.fetch_add(1, std::memory_order_release);
+        tail.notify_one();
+        return true;
+    }
+
+    // returns false once the queue is closed and drained
+    bool pop(T& item) {
+        size_t current = head.load(std::memory_order_relaxed) & ~CLOSED;
+        size_t observed = tail.load(std::memory_order_acquire);
+        while ((observed & ~CLOSED) == current) {
+            if (observed & CLOSED)
+                return false;
+            tail.wait(observed, std::memory_order_acquire);
+            observed = tail.load(std::memory_order_acquire);
+        }
+        item = std::move(slots[current % slots.size()]);
+        head.fetch_add(1, std::memory_order_release);
+        head.notify_one();
+        return true;
+    }
+
+    //* may be called from any thread, the flag goes into both counters so whichever side is asleep wakes up
+    void close() {
+        head.fetch_or(CLOSED, std::memory_order_release);
+        tail.fetch_or(CLOSED, std::memory_order_release);
+        head.notify_all();
+        tail.notify_all();
+    }
+
+private:
+    //* head and tail count pops and pushes, the top bit is the closed flag and the rest never gets near it
+    static constexpr size_t CLOSED = ~(~size_t(0) >> 1);
+
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif // BOUNDED_QUEUE_HPP
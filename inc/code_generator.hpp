@@ -9,22 +9,74 @@
 #include <map>
 #include <set>
 
+// programs with more top-level statements than this are emitted on multiple threads
+constexpr size_t PARALLEL_CODEGEN_THRESHOLD = 4096;
+
+enum class ProfileMode {
+    OFF,
+    HITS,   // count executions per source line
+    TIME    // counts plus clock_gettime time per source line
+};
+
+enum class StatementKind {
+    ASSIGNMENT,
+    PRINT,
+    EXPRESSION
+};
+
+// a top-level statement after name and type resolution, ready to be emitted independently
+struct ResolvedStatement {
+    StatementKind kind;
+    ASTNode* node;          // assignment, print argument or bare expression
+    std::string cType;      // declared C type, empty for re-assignments
+    std::string format;     // printf format specifier for print statements
+    size_t lineNumber;      // source line of the statement
+};
+
 class CodeGenerator {
 public:
-    CodeGenerator(std::vector<std::unique_ptr<ASTNode>>&& nodes);
+    CodeGenerator(std::vector<std::unique_ptr<ASTNode>>&& nodes, ProfileMode profileMode = ProfileMode::OFF,
+                  const std::string& sourceFileName = "", const std::string& functionName = "main");
+
+    // outputFileName is where the code is written, #line directives point the footer back at it
+    std::vector<std::string> generateCode(const std::string& outputFileName = "");
+    // only the function without its footer, the caller emits getIncludes() and the footer itself (used to combine several scripts)
+    std::vector<std::string> generateFunction();
+    const std::vector<std::string>& getIncludes() const;
+
+    //* streaming use: feed statement batches in order, then wrap the collected lines in header and footer
+    std::vector<std::string> generateBatch(std::vector<std::unique_ptr<ASTNode>>&& batch, bool lastBatch);
+    std::vector<std::string> generateHeader(bool withIncludes = true);
+    // firstLine is the line of the footer in outputFileName, without a file name no #line directive is added
+    std::vector<std::string> generateFooter(size_t firstLine = 0, const std::string& outputFileName = "") const;
 
-    std::vector<std::string> generateCode();
+    static std::string lineDirective(size_t lineNumber, const std::string& fileName);
 
 private:
+    static std::string quoteFileName(const std::string& fileName);
+    std::vector<std::string> generateUnit(bool withIncludes);
+    std::vector<std::string> generateStatements();
     std::string inferType(ASTNode* node);
+    void addInclude(const std::string& include);
+    std::vector<std::string> generateProfilerPrelude() const;
     ASTNode* peek(int offset);
     ASTNode* advance();
-    std::vector<std::string> generateCodeForNode(ASTNode* node);
+    std::vector<ResolvedStatement> resolveStatements();
+    void resolveNode(ASTNode* node, std::vector<ResolvedStatement>& statements);
+    void validateExpression(ASTNode* node);
+    std::vector<std::string> emitStatements(const std::vector<ResolvedStatement>& statements) const;
+    void emitStatement(const ResolvedStatement& statement, std::vector<std::string>& out) const;
+    std::string generateExpression(ASTNode* node) const;
 
     size_t currentIndex;
+    ProfileMode profileMode;
+    std::string lineDirectiveFile; // quoted source name for #line, empty to omit them
+    std::string functionName;
+    size_t maxLineNumber;
     std::vector<std::string> includes;
-    std::vector<std::string> code;
     std::vector<std::unique_ptr<ASTNode>> nodes;
+    std::unique_ptr<ASTNode> pendingKeyword; // print at the end of a batch, its argument is in the next one
+    bool holdTrailingKeyword;
     std::map<std::string, std::string> variableTypes;
     std::set<std::string> declaredVariables;
 };
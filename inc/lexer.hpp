@@ -6,6 +6,9 @@
 #include <vector>
 #include <unordered_set>
 
+// inputs larger than this are split at line boundaries and lexed on multiple threads
+constexpr size_t PARALLEL_LEX_THRESHOLD = 1 << 20;
+
 enum class TokenType {
     IDENTIFIER,
     KEYWORD,
@@ -48,11 +51,15 @@ struct Token {
 
 class Lexer {
 public:
-    Lexer(const std::string& src);
+    Lexer(const std::string& src, size_t firstLine = 1);
 
     std::vector<Token> tokenize();
+    std::vector<Token> tokenizeParallel(size_t threadCount);
 
 private:
+    std::vector<Token> tokenizeSerial();
+    void tokenizeInto(std::vector<Token>& tokens);
+    std::vector<size_t> findSplitPoints(size_t chunkCount) const;
     char peek();
     char advance();
     Token readIdentifier();
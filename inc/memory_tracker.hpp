@@ -0,0 +1,48 @@
+#pragma once
+#ifndef MEMORY_TRACKER_HPP
+#define MEMORY_TRACKER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+
+struct MemoryStats {
+    size_t allocations;
+    size_t bytesAllocated;
+    size_t liveBytes;
+    size_t peakLiveBytes;
+};
+
+// counters fed by the replaced global operator new/delete, only updated once enabled
+class MemoryTracker {
+public:
+    static void enable();
+    static bool isEnabled();
+    static MemoryStats snapshot();
+    static void resetPeak();
+};
+
+struct MemoryPhase {
+    std::string name;
+    std::string subsystem;
+    size_t allocations;
+    size_t bytesAllocated;
+    size_t peakLiveBytes;
+    long long retainedBytes;
+};
+
+// collects per-phase deltas of the tracker counters, e.g. begin("lex", "tokens") ... end()
+class MemoryReport {
+public:
+    void begin(std::string_view name, std::string_view subsystem);
+    void end();
+    void print(std::ostream& out) const;
+
+private:
+    std::vector<MemoryPhase> phases;
+    MemoryStats start{};
+};
+
+#endif // MEMORY_TRACKER_HPP
@@ -9,9 +9,13 @@
 
 class Parser {
 public:
-    Parser(const std::vector<Token>& tokens, const std::string& fileName, const std::string& content);
+    // content starts at line firstLine of the file, which is what token line numbers refer to
+    // without exitOnError a syntax error is reported, parsing stops and hasFailed() returns true
+    Parser(const std::vector<Token>& tokens, const std::string& fileName, const std::string& content, size_t firstLine = 1,
+           bool exitOnError = true);
 
     std::vector<std::unique_ptr<ASTNode>> parse();
+    bool hasFailed() const;
 
 private:
     Token peek(int offset, bool skipWhitespace);
@@ -26,6 +30,9 @@ private:
     std::string currentFileName;
     std::string fileContent;
     size_t pos;
+    size_t firstLine;
+    bool exitOnError;
+    bool failed;
 };
 
 #endif // PARSER_HPP
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "lexer.hpp"
+#include "ast.hpp"
+#include "code_generator.hpp"
+#include "semantic_checker.hpp"
+#include "bounded_queue.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// bytes read per batch and batches buffered between two stages, together they bound peak memory
+constexpr size_t STREAM_BATCH_BYTES = 256 * 1024;
+constexpr size_t STREAM_QUEUE_CAPACITY = 4;
+
+struct TextBatch {
+    std::string text;
+    size_t firstLine;
+};
+
+struct TokenBatch {
+    std::vector<Token> tokens;
+    std::string text;
+    size_t firstLine;
+};
+
+using NodeBatch = std::vector<std::unique_ptr<ASTNode>>;
+
+// reader, lexer, parser and emitter running as concurrent stages over batches of complete lines
+class StreamingPipeline {
+public:
+    StreamingPipeline(const std::string& inputFileName, ProfileMode profileMode, const std::string& sourceFileName);
+
+    bool run(const std::string& outputFileName);
+    size_t statementCount() const;
+
+private:
+    void readStage();
+    void lexStage();
+    void parseStage();
+
+    std::string inputFileName;
+    CodeGenerator codeGen;
+    SemanticChecker checker;
+    BoundedQueue<TextBatch> textQueue;
+    BoundedQueue<TokenBatch> tokenQueue;
+    BoundedQueue<NodeBatch> nodeQueue;
+    std::atomic<bool> readFailed;
+    std::atomic<bool> parseFailed;
+    size_t statements;
+};
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// one line of the "reic-profile 1" dump written by programs compiled with --profile
+struct ProfileEntry {
+    size_t lineNumber;
+    unsigned long long hits;
+    unsigned long long nanos;
+};
+
+class ProfileReport {
+public:
+    static bool load(const std::string& path, std::vector<ProfileEntry>& entries);
+    static void print(const std::vector<ProfileEntry>& entries, const std::string& source, std::ostream& out);
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef SEMANTIC_CHECKER_HPP
+#define SEMANTIC_CHECKER_HPP
+
+#include "ast.hpp"
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct SemanticError {
+    size_t lineNumber;
+    std::string message;
+};
+
+// name and type resolution run between parsing and code generation, so programs that would only fail
+// in clang are rejected before any output is written; statements may be fed in several batches
+class SemanticChecker {
+public:
+    void check(const std::vector<std::unique_ptr<ASTNode>>& nodes);
+    void finish();
+    const std::vector<SemanticError>& getErrors() const;
+
+    static void printErrors(const std::vector<SemanticError>& errors, const std::string& fileName, std::ostream& out);
+    static void printSummary(size_t errorCount, std::ostream& out);
+
+private:
+    void checkStatement(const ASTNode* node);
+    void checkPrintArgument(const ASTNode* node);
+    std::string checkExpression(const ASTNode* node, size_t lineNumber);
+    void error(size_t lineNumber, const std::string& message);
+
+    std::map<std::string, std::string> variableTypes;
+    std::vector<SemanticError> errors;
+    bool expectPrintArgument = false;
+    size_t printLineNumber = 0;
+};
+
+#endif // SEMANTIC_CHECKER_HPP
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef UNITY_BUILDER_HPP
+#define UNITY_BUILDER_HPP
+
+#include "ast.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// combines many scripts into one C file: one function per script plus a main that picks one by name
+class UnityBuilder {
+public:
+    UnityBuilder(bool lineDirectives);
+
+    bool addScript(const std::string& name, std::vector<std::unique_ptr<ASTNode>>&& nodes, const std::string& sourceFileName);
+    // outputFileName is where the code is written, #line directives switch back to it after every script
+    std::vector<std::string> generateCode(const std::string& outputFileName) const;
+
+private:
+    static std::string functionNameFor(const std::string& name);
+    void addInclude(const std::string& include);
+
+    bool lineDirectives;
+    std::vector<std::string> includes;
+    std::vector<std::string> names;
+    std::vector<std::string> functionNames;
+    std::vector<std::vector<std::string>> functions;
+    std::vector<std::string> footer;
+};
+
+#endif // UNITY_BUILDER_HPP
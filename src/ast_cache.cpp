@@ -0,0 +1,263 @@
+#include "ast_cache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+struct ASTWriter {
+    std::vector<ASTFileNode> nodes;
+    std::vector<uint32_t> links;
+    std::vector<ASTFileString> strings;
+    std::unordered_map<std::string, uint32_t> stringIds;
+    std::string blob;
+
+    uint32_t addString(const std::string& value) {
+        auto [it, inserted] = stringIds.try_emplace(value, static_cast<uint32_t>(strings.size()));
+        if (inserted) {
+            strings.push_back({ static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(value.size()) });
+            blob += value;
+        }
+        return it->second;
+    }
+
+    uint32_t addNode(const ASTNode* node) {
+        if (!node)
+            return AST_FILE_NONE;
+
+        ASTFileNode record = { static_cast<uint32_t>(node->type), static_cast<uint32_t>(node->lineNumber), 0, 0 };
+        switch (node->type) {
+            case NodeType::STRING:
+                record.a = addString(static_cast<const StringNode*>(node)->value);
+                break;
+            case NodeType::NUMBER:
+                record.a = static_cast<uint32_t>(static_cast<const NumberNode*>(node)->value);
+                break;
+            case NodeType::IDENTIFIER:
+                record.a = addString(static_cast<const IdentifierNode*>(node)->name);
+                break;
+            case NodeType::KEYWORD:
+                record.a = addString(static_cast<const KeywordNode*>(node)->name);
+                break;
+            case NodeType::BINARY_OP: {
+                auto binaryNode = static_cast<const BinaryOpNode*>(node);
+                std::vector<uint32_t> operands;
+                operands.reserve(binaryNode->operands.size());
+                for (const auto& operand : binaryNode->operands) {
+                    operands.push_back(addNode(operand.get()));
+                }
+                record.a = static_cast<uint32_t>(links.size());
+                record.b = static_cast<uint32_t>(operands.size());
+                for (size_t i = 0; i < operands.size(); ++i) {
+                    if (i > 0)
+                        links.push_back(addString(binaryNode->ops[i - 1]));
+                    links.push_back(operands[i]);
+                }
+                break;
+            }
+            case NodeType::ASSIGNMENT: {
+                auto assignNode = static_cast<const AssignmentNode*>(node);
+                record.a = addString(assignNode->variable);
+                record.b = addNode(assignNode->value.get());
+                break;
+            }
+        }
+
+        nodes.push_back(record);
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+};
+
+template <typename T>
+void appendRaw(std::string& out, const T* data, size_t count) {
+    out.append(reinterpret_cast<const char*>(data), sizeof(T) * count);
+}
+
+template <typename T>
+T readRaw(const std::string& data, size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+uint64_t ASTCache::hashSource(const std::string& content) {
+    //* FNV-1a, salted with the format version so a format change invalidates old caches
+    uint64_t hash = 14695981039346656037ULL ^ AST_FILE_VERSION;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string ASTCache::cachePathFor(const std::string& sourceFile) {
+    std::filesystem::path path(sourceFile);
+    return (path.parent_path() / ".reic-cache" / (path.filename().string() + ".ast")).string();
+}
+
+std::string ASTCache::serialize(const std::vector<std::unique_ptr<ASTNode>>& nodes, const ASTSourceInfo& source) {
+    ASTWriter writer;
+    uint32_t sourceFile = source.fileName.empty() ? AST_FILE_NONE : writer.addString(source.fileName);
+    std::vector<uint32_t> roots;
+    roots.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        roots.push_back(writer.addNode(node.get()));
+    }
+
+    //* pad the blob so a following file section would stay aligned
+    writer.blob.resize((writer.blob.size() + 3) & ~size_t(3), '\0');
+
+    ASTFileHeader header = {};
+    std::memcpy(header.magic, AST_FILE_MAGIC, sizeof(header.magic));
+    header.version = AST_FILE_VERSION;
+    header.rootCount = static_cast<uint32_t>(roots.size());
+    header.sourceHash = source.hash;
+    header.nodeCount = static_cast<uint32_t>(writer.nodes.size());
+    header.stringCount = static_cast<uint32_t>(writer.strings.size());
+    header.blobSize = static_cast<uint32_t>(writer.blob.size());
+    header.sourceFile = sourceFile;
+    header.linkCount = static_cast<uint32_t>(writer.links.size());
+
+    std::string out;
+    out.reserve(sizeof(header) + roots.size() * sizeof(uint32_t) + writer.nodes.size() * sizeof(ASTFileNode)
+                + writer.links.size() * sizeof(uint32_t) + writer.strings.size() * sizeof(ASTFileString) + writer.blob.size());
+    appendRaw(out, &header, 1);
+    appendRaw(out, roots.data(), roots.size());
+    appendRaw(out, writer.nodes.data(), writer.nodes.size());
+    appendRaw(out, writer.links.data(), writer.links.size());
+    appendRaw(out, writer.strings.data(), writer.strings.size());
+    out += writer.blob;
+    return out;
+}
+
+bool ASTCache::deserialize(const std::string& data, std::vector<std::unique_ptr<ASTNode>>& nodes, ASTSourceInfo& source) {
+    if (data.size() < sizeof(ASTFileHeader))
+        return false;
+
+    auto header = readRaw<ASTFileHeader>(data, 0);
+    if (std::memcmp(header.magic, AST_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != AST_FILE_VERSION)
+        return false;
+
+    size_t rootsOffset = sizeof(ASTFileHeader);
+    size_t nodesOffset = rootsOffset + size_t(header.rootCount) * sizeof(uint32_t);
+    size_t linksOffset = nodesOffset + size_t(header.nodeCount) * sizeof(ASTFileNode);
+    size_t stringsOffset = linksOffset + size_t(header.linkCount) * sizeof(uint32_t);
+    size_t blobOffset = stringsOffset + size_t(header.stringCount) * sizeof(ASTFileString);
+    if (blobOffset + header.blobSize != data.size())
+        return false;
+
+    std::vector<std::string> strings;
+    strings.reserve(header.stringCount);
+    for (uint32_t i = 0; i < header.stringCount; ++i) {
+        auto entry = readRaw<ASTFileString>(data, stringsOffset + i * sizeof(ASTFileString));
+        if (size_t(entry.offset) + entry.length > header.blobSize)
+            return false;
+        strings.emplace_back(data, blobOffset + entry.offset, entry.length);
+    }
+
+    if (header.sourceFile != AST_FILE_NONE && header.sourceFile >= strings.size())
+        return false;
+
+    //* children precede their parent, so every node can be built in one forward pass
+    std::vector<std::unique_ptr<ASTNode>> built(header.nodeCount);
+    auto stringAt = [&](uint32_t id) -> const std::string* {
+        return id < strings.size() ? &strings[id] : nullptr;
+    };
+    auto link = [&](size_t index) {
+        return readRaw<uint32_t>(data, linksOffset + index * sizeof(uint32_t));
+    };
+    auto child = [&](uint32_t id, uint32_t parent, std::unique_ptr<ASTNode>& out) {
+        if (id == AST_FILE_NONE)
+            return true;
+        if (id >= parent || !built[id])
+            return false;
+        out = std::move(built[id]);
+        return true;
+    };
+
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        auto record = readRaw<ASTFileNode>(data, nodesOffset + i * sizeof(ASTFileNode));
+        switch (static_cast<NodeType>(record.type)) {
+            case NodeType::STRING:
+                if (!stringAt(record.a)) return false;
+                built[i] = std::make_unique<StringNode>(*stringAt(record.a));
+                break;
+            case NodeType::NUMBER:
+                built[i] = std::make_unique<NumberNode>(static_cast<int>(record.a));
+                break;
+            case NodeType::IDENTIFIER:
+                if (!stringAt(record.a)) return false;
+                built[i] = std::make_unique<IdentifierNode>(*stringAt(record.a));
+                break;
+            case NodeType::KEYWORD:
+                if (!stringAt(record.a)) return false;
+                built[i] = std::make_unique<KeywordNode>(*stringAt(record.a));
+                break;
+            case NodeType::BINARY_OP: {
+                size_t first = record.a;
+                size_t count = record.b;
+                if (count < 2 || first + 2 * count - 1 > header.linkCount) return false;
+
+                std::unique_ptr<ASTNode> left, right;
+                if (!child(link(first), i, left) || !stringAt(link(first + 1)) || !child(link(first + 2), i, right)) return false;
+                auto binaryNode = std::make_unique<BinaryOpNode>(std::move(left), *stringAt(link(first + 1)), std::move(right));
+                for (size_t operand = 2; operand < count; ++operand) {
+                    size_t at = first + 2 * operand;
+                    if (!stringAt(link(at - 1)) || !child(link(at), i, right)) return false;
+                    binaryNode->append(*stringAt(link(at - 1)), std::move(right));
+                }
+                built[i] = std::move(binaryNode);
+                break;
+            }
+            case NodeType::ASSIGNMENT: {
+                std::unique_ptr<ASTNode> value;
+                if (!stringAt(record.a) || !child(record.b, i, value) || !value) return false;
+                built[i] = std::make_unique<AssignmentNode>(*stringAt(record.a), std::move(value));
+                break;
+            }
+            default:
+                return false;
+        }
+        built[i]->lineNumber = record.line;
+    }
+
+    nodes.clear();
+    nodes.reserve(header.rootCount);
+    for (uint32_t i = 0; i < header.rootCount; ++i) {
+        auto root = readRaw<uint32_t>(data, rootsOffset + i * sizeof(uint32_t));
+        if (root >= built.size() || !built[root])
+            return false;
+        nodes.push_back(std::move(built[root]));
+    }
+
+    source.hash = header.sourceHash;
+    source.fileName = header.sourceFile == AST_FILE_NONE ? "" : strings[header.sourceFile];
+    return true;
+}
+
+bool ASTCache::save(const std::string& path, const std::vector<std::unique_ptr<ASTNode>>& nodes, const ASTSourceInfo& source) {
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, ec);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    std::string data = serialize(nodes, source);
+    file.write(data.data(), data.size());
+    return file.good();
+}
+
+bool ASTCache::load(const std::string& path, std::vector<std::unique_ptr<ASTNode>>& nodes, ASTSourceInfo& source) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return deserialize(buffer.str(), nodes, source);
+}
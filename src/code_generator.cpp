@@ -1,37 +1,128 @@
 #include "code_generator.hpp"
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <thread>
 
-CodeGenerator::CodeGenerator(std::vector<std::unique_ptr<ASTNode>>&& nodes) : currentIndex(0), nodes(std::move(nodes)) {}
+CodeGenerator::CodeGenerator(std::vector<std::unique_ptr<ASTNode>>&& nodes, ProfileMode profileMode, const std::string& sourceFileName,
+                             const std::string& functionName)
+    : currentIndex(0), profileMode(profileMode), functionName(functionName), maxLineNumber(0), nodes(std::move(nodes)), holdTrailingKeyword(false) {
+    if (!sourceFileName.empty()) {
+        lineDirectiveFile = quoteFileName(sourceFileName);
+    }
+}
 
-std::vector<std::string> CodeGenerator::generateCode() {
-    std::vector<std::string> generatedCode;
-    std::vector<std::string> processedCode;
+std::string CodeGenerator::quoteFileName(const std::string& fileName) {
+    std::string quoted = "\"";
+    for (char c : fileName) {
+        if (c == '\\' || c == '"') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
 
-    //* process all nodes
-    for (currentIndex = 0; currentIndex < nodes.size(); ++currentIndex) {
-        auto nodeCode = generateCodeForNode(nodes[currentIndex].get());
-        processedCode.insert(processedCode.end(), nodeCode.begin(), nodeCode.end());
+std::string CodeGenerator::lineDirective(size_t lineNumber, const std::string& fileName) {
+    return "#line " + std::to_string(lineNumber) + " " + quoteFileName(fileName);
+}
+
+std::vector<std::string> CodeGenerator::generateCode(const std::string& outputFileName) {
+    auto generatedCode = generateUnit(true);
+    for (auto& line : generateFooter(generatedCode.size() + 1, outputFileName)) {
+        generatedCode.push_back(std::move(line));
     }
+    return generatedCode;
+}
 
-    //* include headers
-    for (auto& include : includes) {
-        generatedCode.push_back("#include " + include);
+std::vector<std::string> CodeGenerator::generateFunction() {
+    return generateUnit(false);
+}
+
+const std::vector<std::string>& CodeGenerator::getIncludes() const {
+    return includes;
+}
+
+std::vector<std::string> CodeGenerator::generateUnit(bool withIncludes) {
+    auto processedCode = generateStatements();
+    auto generatedCode = generateHeader(withIncludes);
+    generatedCode.reserve(generatedCode.size() + processedCode.size() + 2);
+
+    //* add processed code
+    for (auto& line : processedCode) {
+        generatedCode.push_back(std::move(line));
     }
 
-    if (!includes.empty()) {
-        generatedCode.push_back("");
+    return generatedCode;
+}
+
+std::vector<std::string> CodeGenerator::generateStatements() {
+    //* pass 1: resolve names, types and includes in source order
+    auto statements = resolveStatements();
+
+    //* pass 2: render statements, they no longer depend on each other
+    return emitStatements(statements);
+}
+
+std::vector<std::string> CodeGenerator::generateBatch(std::vector<std::unique_ptr<ASTNode>>&& batch, bool lastBatch) {
+    if (pendingKeyword) {
+        batch.insert(batch.begin(), std::move(pendingKeyword));
     }
 
-    generatedCode.push_back("int main() {");
+    nodes = std::move(batch);
+    holdTrailingKeyword = !lastBatch;
+    auto code = generateStatements();
+    holdTrailingKeyword = false;
+    nodes.clear();
 
-    //* add processed code
-    for (const auto& line : processedCode) {
-        generatedCode.push_back("    " + line);
+    return code;
+}
+
+std::vector<std::string> CodeGenerator::generateFooter(size_t firstLine, const std::string& outputFileName) const {
+    //* the footer and everything after it is generated code, not the last statement of the script
+    if (!lineDirectiveFile.empty() && !outputFileName.empty()) {
+        return { lineDirective(firstLine + 1, outputFileName), "    return 0;", "}" };
     }
+    return { "    return 0;", "}" };
+}
+
+// includes and declarations depend on every statement, so this must run after all of them were generated
+std::vector<std::string> CodeGenerator::generateHeader(bool withIncludes) {
+    if (profileMode != ProfileMode::OFF) {
+        addInclude("<stdio.h>");
+        addInclude("<stdlib.h>");
+        if (profileMode == ProfileMode::TIME) {
+            addInclude("<time.h>");
+        }
+    }
+
+    std::vector<std::string> generatedCode;
 
-    generatedCode.push_back("    return 0;");
-    generatedCode.push_back("}");
+    //* include headers
+    if (withIncludes) {
+        for (auto& include : includes) {
+            generatedCode.push_back("#include " + include);
+        }
+
+        if (!includes.empty()) {
+            generatedCode.push_back("");
+        }
+    }
+
+    if (profileMode != ProfileMode::OFF) {
+        for (auto& line : generateProfilerPrelude()) {
+            generatedCode.push_back(std::move(line));
+        }
+    }
+
+    generatedCode.push_back("int " + functionName + "() {");
+
+    if (profileMode != ProfileMode::OFF) {
+        generatedCode.push_back("    atexit(reic_prof_dump);");
+        if (profileMode == ProfileMode::TIME) {
+            generatedCode.push_back("    unsigned long long reic_prof_start;");
+        }
+    }
 
     return generatedCode;
 }
@@ -51,6 +142,42 @@ std::string CodeGenerator::inferType(ASTNode* node) {
     }
 }
 
+void CodeGenerator::addInclude(const std::string& include) {
+    if (std::find(includes.begin(), includes.end(), include) == includes.end()) {
+        includes.push_back(include);
+    }
+}
+
+// per-line counters and the atexit hook that dumps them in the format read by --profile-report
+std::vector<std::string> CodeGenerator::generateProfilerPrelude() const {
+    std::string size = std::to_string(maxLineNumber + 1);
+    std::vector<std::string> prelude;
+
+    prelude.push_back("static unsigned long long reic_prof_hits[" + size + "];");
+    prelude.push_back("static unsigned long long reic_prof_nanos[" + size + "];");
+    if (profileMode == ProfileMode::TIME) {
+        prelude.push_back("");
+        prelude.push_back("static unsigned long long reic_prof_now(void) {");
+        prelude.push_back("    struct timespec ts;");
+        prelude.push_back("    clock_gettime(CLOCK_MONOTONIC, &ts);");
+        prelude.push_back("    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;");
+        prelude.push_back("}");
+    }
+    prelude.push_back("");
+    prelude.push_back("static void reic_prof_dump(void) {");
+    prelude.push_back("    const char* path = getenv(\"REIC_PROFILE\");");
+    prelude.push_back("    FILE* out = fopen(path ? path : \"reic.profile\", \"w\");");
+    prelude.push_back("    if (!out) return;");
+    prelude.push_back("    fprintf(out, \"reic-profile 1\\n\");");
+    prelude.push_back("    for (unsigned long line = 0; line < " + size + "; ++line) {");
+    prelude.push_back("        if (reic_prof_hits[line]) fprintf(out, \"%lu %llu %llu\\n\", line, reic_prof_hits[line], reic_prof_nanos[line]);");
+    prelude.push_back("    }");
+    prelude.push_back("    fclose(out);");
+    prelude.push_back("}");
+    prelude.push_back("");
+    return prelude;
+}
+
 ASTNode* CodeGenerator::peek(int offset = 0) {
     size_t index = currentIndex + offset;
 
@@ -64,13 +191,40 @@ ASTNode* CodeGenerator::advance() {
     return currentIndex < nodes.size() ? nodes[currentIndex++].get() : nullptr;
 }
 
-std::vector<std::string> CodeGenerator::generateCodeForNode(ASTNode* node) {
-    std::vector<std::string> code;
+std::vector<ResolvedStatement> CodeGenerator::resolveStatements() {
+    std::vector<ResolvedStatement> statements;
+    statements.reserve(nodes.size());
 
+    for (currentIndex = 0; currentIndex < nodes.size(); ++currentIndex) {
+        resolveNode(nodes[currentIndex].get(), statements);
+    }
+
+    for (const auto& statement : statements) {
+        maxLineNumber = std::max(maxLineNumber, statement.lineNumber);
+    }
+
+    return statements;
+}
+
+void CodeGenerator::validateExpression(ASTNode* node) {
+    if (auto binaryOpNode = dynamic_cast<BinaryOpNode*>(node)) {
+        for (const auto& operand : binaryOpNode->operands) {
+            if (!operand) {
+                std::cerr << "[warn]: Binary operation with null operand" << std::endl;
+                return;
+            }
+        }
+        for (const auto& operand : binaryOpNode->operands) {
+            validateExpression(operand.get());
+        }
+    }
+}
+
+void CodeGenerator::resolveNode(ASTNode* node, std::vector<ResolvedStatement>& statements) {
     if (auto assignmentNode = dynamic_cast<AssignmentNode*>(node)) {
         std::string varName = assignmentNode->variable;
         ASTNode* rhsNode = assignmentNode->value.get();
-        std::string valueCode = generateCodeForNode(rhsNode)[0];
+        validateExpression(rhsNode);
         std::string resolvedVarType;
 
         if (rhsNode->type == NodeType::IDENTIFIER) {
@@ -94,34 +248,17 @@ std::vector<std::string> CodeGenerator::generateCodeForNode(ASTNode* node) {
 
         variableTypes[varName] = resolvedVarType; // Store/update variable's C type
 
-        if (declaredVariables.find(varName) == declaredVariables.end()) {
-            code.push_back(resolvedVarType + " " + varName + " = " + valueCode + ";");
-            declaredVariables.insert(varName);
+        if (declaredVariables.insert(varName).second) {
+            statements.push_back({ StatementKind::ASSIGNMENT, assignmentNode, resolvedVarType, "", node->lineNumber });
         } else {
-            code.push_back(varName + " = " + valueCode + ";"); // Re-assignment
+            statements.push_back({ StatementKind::ASSIGNMENT, assignmentNode, "", "", node->lineNumber }); // Re-assignment
         }
-    } else if (auto stringNode = dynamic_cast<StringNode*>(node)) {
-        code.push_back("\"" + stringNode->value + "\"");
-    } else if (auto numberNode = dynamic_cast<NumberNode*>(node)) {
-        code.push_back(std::to_string(numberNode->value));
-    } else if (auto binaryOpNode = dynamic_cast<BinaryOpNode*>(node)) {
-        if (!binaryOpNode->left || !binaryOpNode->right) {
-            std::cerr << "[warn]: Binary operation with null operand" << std::endl;
-            return code;
-        }
-        std::string leftCode = generateCodeForNode(binaryOpNode->left.get())[0];
-        std::string rightCode = generateCodeForNode(binaryOpNode->right.get())[0];
-        code.push_back(leftCode + " " + binaryOpNode->op + " " + rightCode);
-    } else if (auto identifierNode = dynamic_cast<IdentifierNode*>(node)) {
-        code.push_back(identifierNode->name);
     } else if (auto keywordNode = dynamic_cast<KeywordNode*>(node)) {
         if (keywordNode->name == "print") {
-            if (std::find(includes.begin(), includes.end(), "<stdio.h>") == includes.end()) {
-                includes.push_back("<stdio.h>");
-            }
+            addInclude("<stdio.h>");
             ASTNode* nextNode = peek(1);
             if (nextNode) {
-                std::string printArg = generateCodeForNode(nextNode)[0];
+                validateExpression(nextNode);
                 std::string cTypeToPrint;
 
                 switch (nextNode->type) {
@@ -158,25 +295,141 @@ std::vector<std::string> CodeGenerator::generateCodeForNode(ASTNode* node) {
                 } else {
                     if (cTypeToPrint != "unknown_type" && cTypeToPrint != "unsupported_type") {
                         // This case means a known variable has a C type we don't explicitly handle for printing yet.
-                        std::cerr << "[warn]: Variable '" << printArg << "' has C type '" << cTypeToPrint << "' which may not print correctly with default format. Defaulting to %s." << std::endl;
+                        std::cerr << "[warn]: Variable '" << generateExpression(nextNode) << "' has C type '" << cTypeToPrint << "' which may not print correctly with default format. Defaulting to %s." << std::endl;
                         formatSpecifier = "%s"; // Default for other C types, might be incorrect.
                     }
                     // If type is "unknown_type" or "unsupported_type", formatSpecifier remains empty, and no printf is generated.
                 }
 
                 if (!formatSpecifier.empty()) {
-                    code.push_back("printf(\"" + formatSpecifier + "\\n\", " + printArg + ");");
+                    statements.push_back({ StatementKind::PRINT, nextNode, cTypeToPrint, formatSpecifier, node->lineNumber });
                 }
                 advance(); // Skip the next node since it's already processed
+            } else if (holdTrailingKeyword) {
+                pendingKeyword = std::move(nodes[currentIndex]);
             } else {
                 std::cerr << "[warn]: Missing argument for print statement" << std::endl;
             }
         } else {
             std::cerr << "[warn]: Unsupported keyword: " << keywordNode->name << std::endl;
         }
+    } else if (node->type == NodeType::STRING || node->type == NodeType::NUMBER
+               || node->type == NodeType::BINARY_OP || node->type == NodeType::IDENTIFIER) {
+        validateExpression(node);
+        statements.push_back({ StatementKind::EXPRESSION, node, "", "", node->lineNumber });
     } else {
         std::cerr << "[warn]: Unknown AST node type" << std::endl;
     }
+}
+
+std::vector<std::string> CodeGenerator::emitStatements(const std::vector<ResolvedStatement>& statements) const {
+    size_t threadCount = 1;
+    if (statements.size() > PARALLEL_CODEGEN_THRESHOLD) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkSize = (statements.size() + threadCount - 1) / threadCount;
+
+    //* every thread renders a contiguous range into its own buffer, buffers are joined in order
+    std::vector<std::vector<std::string>> buffers(threadCount);
+    auto emitChunk = [&](size_t chunk) {
+        size_t begin = std::min(chunk * chunkSize, statements.size());
+        size_t end = std::min(begin + chunkSize, statements.size());
+        buffers[chunk].reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            emitStatement(statements[i], buffers[chunk]);
+        }
+    };
+
+    if (threadCount == 1) {
+        emitChunk(0);
+        return std::move(buffers[0]);
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (size_t chunk = 0; chunk < threadCount; ++chunk) {
+        workers.emplace_back(emitChunk, chunk);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t lineCount = 0;
+    for (const auto& buffer : buffers) {
+        lineCount += buffer.size();
+    }
 
+    std::vector<std::string> code;
+    code.reserve(lineCount);
+    for (auto& buffer : buffers) {
+        std::move(buffer.begin(), buffer.end(), std::back_inserter(code));
+    }
     return code;
 }
+
+void CodeGenerator::emitStatement(const ResolvedStatement& statement, std::vector<std::string>& out) const {
+    //* let debuggers and profilers attribute the statement to its .reic line
+    if (!lineDirectiveFile.empty() && statement.lineNumber > 0) {
+        out.push_back("#line " + std::to_string(statement.lineNumber) + " " + lineDirectiveFile);
+    }
+
+    std::string code;
+    switch (statement.kind) {
+        case StatementKind::ASSIGNMENT: {
+            auto assignmentNode = static_cast<AssignmentNode*>(statement.node);
+            std::string valueCode = generateExpression(assignmentNode->value.get());
+            if (!statement.cType.empty()) {
+                code = statement.cType + " " + assignmentNode->variable + " = " + valueCode + ";";
+            } else {
+                code = assignmentNode->variable + " = " + valueCode + ";"; // Re-assignment
+            }
+            break;
+        }
+        case StatementKind::PRINT:
+            code = "printf(\"" + statement.format + "\\n\", " + generateExpression(statement.node) + ");";
+            break;
+        case StatementKind::EXPRESSION:
+            code = generateExpression(statement.node);
+            break;
+    }
+
+    //* instrumentation shares the statement's physical line, so the #line above covers exactly one source line
+    if (profileMode != ProfileMode::OFF) {
+        std::string line = std::to_string(statement.lineNumber);
+        if (profileMode == ProfileMode::TIME) {
+            code = "reic_prof_start = reic_prof_now(); " + code;
+        }
+        code += " reic_prof_hits[" + line + "]++;";
+        if (profileMode == ProfileMode::TIME) {
+            code += " reic_prof_nanos[" + line + "] += reic_prof_now() - reic_prof_start;";
+        }
+    }
+
+    out.push_back("    " + code);
+}
+
+std::string CodeGenerator::generateExpression(ASTNode* node) const {
+    if (auto stringNode = dynamic_cast<StringNode*>(node)) {
+        return "\"" + stringNode->value + "\"";
+    } else if (auto numberNode = dynamic_cast<NumberNode*>(node)) {
+        return std::to_string(numberNode->value);
+    } else if (auto binaryOpNode = dynamic_cast<BinaryOpNode*>(node)) {
+        for (const auto& operand : binaryOpNode->operands) {
+            if (!operand) {
+                return ""; // reported during resolution
+            }
+        }
+        //* append into one buffer, the chain can have hundreds of thousands of operands
+        std::string code = generateExpression(binaryOpNode->operands[0].get());
+        for (size_t i = 1; i < binaryOpNode->operands.size(); ++i) {
+            code += ' ';
+            code += binaryOpNode->ops[i - 1];
+            code += ' ';
+            code += generateExpression(binaryOpNode->operands[i].get());
+        }
+        return code;
+    } else if (auto identifierNode = dynamic_cast<IdentifierNode*>(node)) {
+        return identifierNode->name;
+    }
+    return "";
+}
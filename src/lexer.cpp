@@ -1,6 +1,9 @@
 #include "lexer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
-Lexer::Lexer(const std::string& src) : source(src), pos(0), lineNumber(1), columnNumber(1), keywords({"if", "while", "return", "print"}) {}
+Lexer::Lexer(const std::string& src, size_t firstLine) : source(src), pos(0), lineNumber(firstLine), columnNumber(1), keywords({"if", "while", "return", "print"}) {}
 
 char Lexer::peek() {
     return pos < source.size() ? source[pos] : '\0';
@@ -48,9 +51,7 @@ Token Lexer::readString() {
     return { TokenType::STRING, value, lineNumber, columnNumber };
 }
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
-
+void Lexer::tokenizeInto(std::vector<Token>& tokens) {
     while (pos < source.size()) {
         char current = peek();
         if (current == '\0')
@@ -76,7 +77,94 @@ std::vector<Token> Lexer::tokenize() {
         else
             tokens.push_back(readIdentifier());
     }
+}
+
+std::vector<Token> Lexer::tokenizeSerial() {
+    std::vector<Token> tokens;
+    tokenizeInto(tokens);
+    tokens.push_back({ TokenType::END_OF_FILE, "EOF", lineNumber, columnNumber });
+    return tokens;
+}
+
+std::vector<Token> Lexer::tokenize() {
+    if (source.size() > PARALLEL_LEX_THRESHOLD)
+        return tokenizeParallel(std::thread::hardware_concurrency());
+    return tokenizeSerial();
+}
+
+// returns chunk start offsets, each one right after a newline that is not inside a string literal
+std::vector<size_t> Lexer::findSplitPoints(size_t chunkCount) const {
+    std::vector<size_t> points = { 0 };
+    const char* data = source.data();
+    size_t size = source.size();
+    size_t scanned = 0;
+    bool inString = false;
+
+    for (size_t i = 1; i < chunkCount; ++i) {
+        size_t target = std::max(size * i / chunkCount, scanned);
+
+        //* only quotes matter for the string state, so skip to each one with memchr
+        while (auto quote = static_cast<const char*>(memchr(data + scanned, '"', target - scanned))) {
+            inString = !inString;
+            scanned = quote - data + 1;
+        }
+        scanned = target;
+
+        while (scanned < size && (inString || data[scanned] != '\n')) {
+            if (data[scanned] == '"')
+                inString = !inString;
+            scanned++;
+        }
+
+        if (++scanned >= size)
+            break;
+        points.push_back(scanned);
+    }
+
+    return points;
+}
+
+std::vector<Token> Lexer::tokenizeParallel(size_t threadCount) {
+    //* a NUL byte stops the serial lexer early, keep that behaviour by not splitting at all
+    if (threadCount < 2 || memchr(source.data(), '\0', source.size()))
+        return tokenizeSerial();
+
+    auto splits = findSplitPoints(threadCount);
+    splits.push_back(source.size());
+    size_t chunkCount = splits.size() - 1;
+
+    std::vector<Lexer> lexers;
+    lexers.reserve(chunkCount);
+    for (size_t i = 0; i < chunkCount; ++i)
+        lexers.emplace_back(source.substr(splits[i], splits[i + 1] - splits[i]));
+
+    std::vector<std::vector<Token>> chunks(chunkCount);
+    std::vector<std::thread> workers;
+    workers.reserve(chunkCount);
+    for (size_t i = 0; i < chunkCount; ++i)
+        workers.emplace_back([&lexers, &chunks, i] { lexers[i].tokenizeInto(chunks[i]); });
+    for (auto& worker : workers)
+        worker.join();
+
+    //* every chunk starts at column 1 of its first line, so only line numbers need shifting
+    size_t tokenCount = 1;
+    for (const auto& chunk : chunks)
+        tokenCount += chunk.size();
+
+    std::vector<Token> tokens;
+    tokens.reserve(tokenCount);
+    size_t lineOffset = lineNumber - 1;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        for (auto& token : chunks[i]) {
+            token.lineNumber += lineOffset;
+            tokens.push_back(std::move(token));
+        }
+        lineOffset += lexers[i].lineNumber - 1;
+    }
 
+    pos = source.size();
+    lineNumber = lineOffset + 1;
+    columnNumber = lexers.back().columnNumber;
     tokens.push_back({ TokenType::END_OF_FILE, "EOF", lineNumber, columnNumber });
     return tokens;
 }
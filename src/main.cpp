@@ -4,6 +4,12 @@
 #include "lexer.hpp"
 #include "code_generator.hpp"
 #include "timer.hpp"
+#include "memory_tracker.hpp"
+#include "ast_cache.hpp"
+#include "profiler.hpp"
+#include "pipeline.hpp"
+#include "unity_builder.hpp"
+#include "semantic_checker.hpp"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -66,9 +72,14 @@ void printAST(const ASTNode* node, int indent = 2) {
             break;
         case NodeType::BINARY_OP: {
             auto binaryNode = dynamic_cast<const BinaryOpNode*>(node);
-            std::cout << padding << "BinaryOp: " << binaryNode->op << std::endl;
-            printAST(binaryNode->left.get(), indent + 2);
-            printAST(binaryNode->right.get(), indent + 2);
+            std::cout << padding << "BinaryOp:";
+            for (const auto& op : binaryNode->ops) {
+                std::cout << " " << op;
+            }
+            std::cout << std::endl;
+            for (const auto& operand : binaryNode->operands) {
+                printAST(operand.get(), indent + 2);
+            }
             break;
         }
         case NodeType::ASSIGNMENT: {
@@ -83,13 +94,23 @@ void printAST(const ASTNode* node, int indent = 2) {
 }
 
 void displayHelp() {
-    std::cout << "Usage: <filename> [-v|--verbose] [-h|--help] [-o <output_file>] [--compile] [--run]" << std::endl;
+    std::cout << "Usage: <filename> [-v|--verbose] [-h|--help] [-o <output_file>] [--compile] [--run] [--mem-report] [--emit-ast <file>] [--from-ast] [--no-cache] [--profile|--profile-time] [--profile-report <file>] [--no-line-directives] [--stream] [--unity <files...>]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -v, --verbose   Enable verbose output" << std::endl;
     std::cout << "  -h, --help      Show this help message" << std::endl;
     std::cout << "  -o <filename>   Specify output file name" << std::endl;
     std::cout << "      --compile   Compile the output file using clang" << std::endl;
     std::cout << "      --run       Run file after compilation" << std::endl;
+    std::cout << "      --mem-report  Report allocations and peak memory per phase" << std::endl;
+    std::cout << "      --emit-ast <file>  Write the parsed AST in binary form and exit" << std::endl;
+    std::cout << "      --from-ast  Read the input file as a binary AST instead of source" << std::endl;
+    std::cout << "      --no-cache  Do not read or write the AST cache in .reic-cache/" << std::endl;
+    std::cout << "      --profile   Count executions per source line in the generated program" << std::endl;
+    std::cout << "      --profile-time  Like --profile, also measuring time per source line" << std::endl;
+    std::cout << "      --profile-report <file>  Print a profile dump against the input source and exit" << std::endl;
+    std::cout << "      --no-line-directives  Do not map generated C back to the source with #line" << std::endl;
+    std::cout << "      --stream    Read, lex, parse and generate concurrently in bounded batches" << std::endl;
+    std::cout << "      --unity     Build all input files into one program, run it as <program> <script name>" << std::endl;
 }
 
 std::string generateRandomString(size_t length) {
@@ -102,6 +123,151 @@ std::string generateRandomString(size_t length) {
     return randomString;
 }
 
+std::vector<std::unique_ptr<ASTNode>> parseSource(const std::string &filename, const std::string &content, MemoryReport &memoryReport) {
+    //* transient objects live in their own scope, so a phase's retained bytes only count what it returns
+    memoryReport.begin("lex", "lexer + tokens");
+    std::vector<Token> tokens;
+    {
+        Lexer lexer(content);
+        tokens = lexer.tokenize();
+    }
+    memoryReport.end();
+
+    verbose("Tokens:");
+    for (const auto &token : tokens) {
+        verbose(std::format("Type: {}, Value: {}", token.humanize(), token.value));
+    }
+    verbose(std::format("Token count: {}", tokens.size()));
+
+    memoryReport.begin("parse", "parser + AST");
+    std::vector<std::unique_ptr<ASTNode>> ast;
+    {
+        Parser parser(tokens, filename, content);
+        ast = parser.parse();
+    }
+    memoryReport.end();
+    return ast;
+}
+
+std::vector<std::unique_ptr<ASTNode>> parseWithCache(const std::string &filename, const std::string &content, bool useCache,
+                                                     MemoryReport &memoryReport, ASTSourceInfo &source) {
+    std::vector<std::unique_ptr<ASTNode>> ast;
+    source.hash = ASTCache::hashSource(content);
+    std::string cachePath = ASTCache::cachePathFor(filename);
+    ASTSourceInfo cached;
+    if (useCache && ASTCache::load(cachePath, ast, cached) && cached.hash == source.hash) {
+        verbose(std::format("Using cached AST: {}", cachePath));
+        return ast;
+    }
+
+    ast = parseSource(filename, content, memoryReport);
+    if (useCache && !ast.empty()) {
+        if (ASTCache::save(cachePath, ast, source)) {
+            verbose(std::format("Wrote AST cache: {}", cachePath));
+        } else {
+            verbose(std::format("Could not write AST cache: {}", cachePath));
+        }
+    }
+    return ast;
+}
+
+// reports every name and type error of the program at once and returns how many there were
+size_t checkSemantics(const std::vector<std::unique_ptr<ASTNode>> &ast, const std::string &filename, MemoryReport &memoryReport) {
+    memoryReport.begin("check", "semantic checker");
+    std::vector<SemanticError> errors;
+    {
+        SemanticChecker checker;
+        checker.check(ast);
+        checker.finish();
+        errors = checker.getErrors();
+    }
+    memoryReport.end();
+
+    if (!errors.empty()) {
+        SemanticChecker::printErrors(errors, filename, std::cerr);
+        return errors.size();
+    }
+    verbose(std::format("Semantic check of {} passed.", filename));
+    return 0;
+}
+
+// compiles every input into its own function of one translation unit
+bool buildUnity(const std::vector<std::string> &inputFiles, const std::string &outputFileName, bool useCache,
+                bool lineDirectives, MemoryReport &memoryReport) {
+    UnityBuilder builder(lineDirectives);
+    size_t semanticErrors = 0;
+
+    for (auto filename : inputFiles) {
+        filename = std::filesystem::absolute(filename).lexically_normal().string();
+        std::string content;
+        tryReadFile(filename, &content);
+
+        ASTSourceInfo source = { 0, filename };
+        auto ast = parseWithCache(filename, content, useCache, memoryReport, source);
+        if (ast.empty()) {
+            std::cerr << "[error]: Failed to create AST for " << filename << std::endl;
+            return false;
+        }
+        //* keep checking the remaining scripts, so one run reports the errors of all of them
+        size_t errors = checkSemantics(ast, filename, memoryReport);
+        if (errors > 0) {
+            semanticErrors += errors;
+            continue;
+        }
+
+        std::string name = std::filesystem::path(filename).stem().string();
+        if (!builder.addScript(name, std::move(ast), filename)) {
+            std::cerr << "[error]: Duplicate script name: " << name << std::endl;
+            return false;
+        }
+        verbose(std::format("Added script {} from {}", name, filename));
+    }
+    if (semanticErrors > 0) {
+        SemanticChecker::printSummary(semanticErrors, std::cerr);
+        return false;
+    }
+
+    auto code = builder.generateCode(outputFileName);
+
+    verbose(std::format("Output file: {}", outputFileName));
+    std::ofstream outputFile(outputFileName);
+    if (!outputFile) {
+        std::cerr << "[error]: Error opening output file: " << outputFileName << std::endl;
+        return false;
+    }
+    for (const auto& line : code) {
+        outputFile << line << '\n';
+    }
+    return true;
+}
+
+int compileOutput(const std::string &outputFileName, bool run, Timer &timer) {
+    std::string command = "clang -g -o " + outputFileName.substr(0, outputFileName.find_last_of('.')) + " " + outputFileName;
+    verbose(std::format("Compiling with command: {}", command));
+    int result = std::system(command.c_str());
+    double elapsedTime = timer.elapsed();
+    timer.reset();
+    if (result != 0) {
+        if (run) std::filesystem::remove(outputFileName);
+        std::cerr << "[error]: Compilation failed." << std::endl;
+        return 1;
+    }
+    std::cout << std::format("Compiled development build [notstripped + debuginfo] in {:.2f}s", elapsedTime) << std::endl;
+    if (run) {
+        std::string executablePath = outputFileName.substr(0, outputFileName.find_last_of('.'));
+        std::cout << "Running build" << std::endl;
+        int runResult = std::system(executablePath.c_str());
+        std::filesystem::remove(outputFileName);
+        std::filesystem::remove(executablePath);
+        if (runResult != 0) {
+            std::cerr << "[error]: Execution failed." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     if (argc < 2) {
         std::cerr << "[error]: No input file specified." << std::endl;
@@ -113,6 +279,16 @@ int main(int argc, char *argv[]) {
     std::string outputFileName = std::filesystem::path(filename).stem().string() + ".c";
     bool compile = false;
     bool run = false;
+    bool memReport = false;
+    bool fromAST = false;
+    bool useCache = true;
+    std::string emitASTFileName;
+    ProfileMode profileMode = ProfileMode::OFF;
+    std::string profileReportFileName;
+    bool lineDirectives = true;
+    bool stream = false;
+    bool unity = false;
+    std::vector<std::string> inputFiles = { filename };
 
     for (int i = 1; i < argc; ++i) {
         if (std::string(argv[i]) == "-v" || std::string(argv[i]) == "--verbose") {
@@ -131,41 +307,194 @@ int main(int argc, char *argv[]) {
             compile = true;
         } else if (std::string(argv[i]) == "--run") {
             run = true;
+        } else if (std::string(argv[i]) == "--mem-report") {
+            memReport = true;
+        } else if (std::string(argv[i]) == "--emit-ast") {
+            if (i + 1 < argc) {
+                emitASTFileName = argv[++i];
+            } else {
+                std::cerr << "[error]: No AST file name specified after --emit-ast" << std::endl;
+                return 1;
+            }
+        } else if (std::string(argv[i]) == "--from-ast") {
+            fromAST = true;
+        } else if (std::string(argv[i]) == "--no-cache") {
+            useCache = false;
+        } else if (std::string(argv[i]) == "--profile") {
+            profileMode = ProfileMode::HITS;
+        } else if (std::string(argv[i]) == "--profile-time") {
+            profileMode = ProfileMode::TIME;
+        } else if (std::string(argv[i]) == "--profile-report") {
+            if (i + 1 < argc) {
+                profileReportFileName = argv[++i];
+            } else {
+                std::cerr << "[error]: No profile file name specified after --profile-report" << std::endl;
+                return 1;
+            }
+        } else if (std::string(argv[i]) == "--no-line-directives") {
+            lineDirectives = false;
+        } else if (std::string(argv[i]) == "--stream") {
+            stream = true;
+        } else if (std::string(argv[i]) == "--unity") {
+            unity = true;
         } else if (std::string(argv[i]) == "--no-compile") {
             compile = false;
         } else if (std::string(argv[i]) == "--no-run") {
             run = false;
         } else {
             if (i == 1) continue; // Skip the first argument (filename)
+            if (argv[i][0] != '-') {
+                inputFiles.push_back(argv[i]);
+                continue;
+            }
             std::cerr << "[error]: Unknown option: " << argv[i] << std::endl;
             return 1;
         }
     }
 
+    if (inputFiles.size() > 1 && !unity) {
+        std::cerr << "[error]: Multiple input files require --unity" << std::endl;
+        return 1;
+    }
+
+    MemoryReport memoryReport;
+    if (memReport) {
+        MemoryTracker::enable();
+    }
+
     verbose(std::format("File name: {}", filename));
     std::string content;
 
     //* get absolute path
     filename = std::filesystem::absolute(filename).lexically_normal().string();
 
-    tryReadFile(filename, &content);
+    if (outputFileName[0] == '/') {
+        outputFileName = std::filesystem::absolute(outputFileName).string();
+    }
 
-    verbose(std::format("File content: {}", content));
+    if (run) {
+        outputFileName = std::filesystem::temp_directory_path().string() + "/" + generateRandomString(8) + ".c";
+    }
 
     Timer timer;
 
-    Lexer lexer(content);
-    auto tokens = lexer.tokenize();
+    if (unity) {
+        if (run) {
+            std::cerr << "[error]: --run is not supported with --unity, the script to run is chosen on the command line of the binary" << std::endl;
+            return 1;
+        }
+        if (profileMode != ProfileMode::OFF) {
+            std::cerr << "[error]: --profile is not supported with --unity" << std::endl;
+            return 1;
+        }
+        if (stream) {
+            std::cerr << "[error]: --stream is not supported with --unity" << std::endl;
+            return 1;
+        }
+        if (!emitASTFileName.empty() || fromAST) {
+            std::cerr << "[error]: --emit-ast and --from-ast are not supported with --unity, there is one AST per input file" << std::endl;
+            return 1;
+        }
+        if (!profileReportFileName.empty()) {
+            std::cerr << "[error]: --profile-report is not supported with --unity" << std::endl;
+            return 1;
+        }
 
-    verbose("Tokens:");
-    for (const auto &token : tokens) {
-        verbose(std::format("Type: {}, Value: {}", token.humanize(), token.value));
+        if (!buildUnity(inputFiles, outputFileName, useCache, lineDirectives, memoryReport)) {
+            return 1;
+        }
+        if (memReport) {
+            memoryReport.print(std::cout);
+        }
+        if (compile) {
+            return compileOutput(outputFileName, false, timer);
+        }
+        return 0;
     }
-    verbose(std::format("Token count: {}", tokens.size()));
 
-    Parser parser(tokens, filename, content);
+    if (stream) {
+        if (!emitASTFileName.empty() || fromAST) {
+            std::cerr << "[error]: --emit-ast and --from-ast are not supported with --stream, the AST is never held in full" << std::endl;
+            return 1;
+        }
+        if (!profileReportFileName.empty()) {
+            std::cerr << "[error]: --profile-report is not supported with --stream" << std::endl;
+            return 1;
+        }
+
+        if (!std::filesystem::exists(filename) && !filename.ends_with(EXTENSION_NAME)) {
+            filename += EXTENSION_NAME;
+        }
+
+        verbose(std::format("Streaming {} to {}", filename, outputFileName));
+        memoryReport.begin("stream", "pipeline batches");
+        bool streamed;
+        size_t statements;
+        {
+            StreamingPipeline pipeline(filename, profileMode, lineDirectives ? filename : "");
+            streamed = pipeline.run(outputFileName);
+            statements = pipeline.statementCount();
+        }
+        memoryReport.end();
+        if (!streamed) {
+            return 1;
+        }
+        verbose(std::format("Statements streamed: {}", statements));
+
+        if (memReport) {
+            memoryReport.print(std::cout);
+        }
+        if (compile || run) {
+            return compileOutput(outputFileName, run, timer);
+        }
+        return 0;
+    }
+
+    std::vector<std::unique_ptr<ASTNode>> ast;
+    ASTSourceInfo source = { 0, filename };
+
+    if (fromAST) {
+        memoryReport.begin("read", "AST file");
+        bool loaded = ASTCache::load(filename, ast, source);
+        memoryReport.end();
+        if (!loaded) {
+            std::cerr << "[error]: Invalid or unsupported AST file: " << filename << std::endl;
+            return 1;
+        }
+        if (source.fileName.empty()) {
+            source.fileName = filename;
+        }
+        verbose(std::format("Loaded AST of {} from {}", source.fileName, filename));
+    } else {
+        memoryReport.begin("read", "file content");
+        tryReadFile(filename, &content);
+        memoryReport.end();
+
+        verbose(std::format("File content: {}", content));
+        timer.reset();
+
+        if (!profileReportFileName.empty()) {
+            std::vector<ProfileEntry> entries;
+            if (!ProfileReport::load(profileReportFileName, entries)) {
+                std::cerr << "[error]: Invalid profile file: " << profileReportFileName << std::endl;
+                return 1;
+            }
+            ProfileReport::print(entries, content, std::cout);
+            return 0;
+        }
+
+        ast = parseWithCache(filename, content, useCache, memoryReport, source);
+
+        if (!emitASTFileName.empty()) {
+            if (!ASTCache::save(emitASTFileName, ast, source)) {
+                std::cerr << "[error]: Error writing AST file: " << emitASTFileName << std::endl;
+                return 1;
+            }
+            verbose(std::format("AST written to {}", emitASTFileName));
+            return 0;
+        }
+    }
 
-    auto ast = parser.parse();
     if (!ast.empty()) {
         verbose("AST created successfully.");
         verbose(std::format("AST size: {}", ast.size()));
@@ -179,8 +508,20 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    CodeGenerator codeGen(std::move(ast));
-    auto code = codeGen.generateCode();
+    if (size_t errors = checkSemantics(ast, source.fileName, memoryReport)) {
+        SemanticChecker::printSummary(errors, std::cerr);
+        return 1;
+    }
+
+    std::vector<std::string> code;
+    {
+        //* constructing only moves the AST in, and it is freed with the generator after the phase,
+        //* so the AST does not show up as memory the code generator gave back
+        CodeGenerator codeGen(std::move(ast), profileMode, lineDirectives ? source.fileName : "");
+        memoryReport.begin("codegen", "code generator + C lines");
+        code = codeGen.generateCode(outputFileName);
+        memoryReport.end();
+    }
 
     verbose("Generated Code:");
     if (isVerbose) {
@@ -189,15 +530,8 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    if (outputFileName[0] == '/') {
-        outputFileName = std::filesystem::absolute(outputFileName).string();
-    }
-
-    if (run) {
-        outputFileName = std::filesystem::temp_directory_path().string() + "/" + generateRandomString(8) + ".c";
-    }
-
     verbose(std::format("Output file: {}", outputFileName));
+    memoryReport.begin("write", "output stream");
     std::ofstream outputFile(outputFileName);
     if (!outputFile) {
         std::cerr << "[error]: Error opening output file: " << outputFileName << std::endl;
@@ -207,29 +541,14 @@ int main(int argc, char *argv[]) {
         outputFile << line << std::endl;
     }
     outputFile.close();
+    memoryReport.end();
+
+    if (memReport) {
+        memoryReport.print(std::cout);
+    }
+
     if (compile || run) {
-        std::string command = "clang -g -o " + outputFileName.substr(0, outputFileName.find_last_of('.')) + " " + outputFileName;
-        verbose(std::format("Compiling with command: {}", command));
-        int result = std::system(command.c_str());
-        double elapsedTime = timer.elapsed();
-        timer.reset();
-        if (result != 0) {
-            if (run) std::filesystem::remove(outputFileName);
-            std::cerr << "[error]: Compilation failed." << std::endl;
-            return 1;
-        }
-        std::cout << std::format("Compiled development build [notstripped + debuginfo] in {:.2f}s", elapsedTime) << std::endl;
-        if (run) {
-            std::string executablePath = outputFileName.substr(0, outputFileName.find_last_of('.'));
-            std::cout << "Running build" << std::endl;
-            int runResult = std::system(executablePath.c_str());
-            std::filesystem::remove(outputFileName);
-            std::filesystem::remove(executablePath);
-            if (runResult != 0) {
-                std::cerr << "[error]: Execution failed." << std::endl;
-                return 1;
-            }
-        }
+        return compileOutput(outputFileName, run, timer);
     }
 
     return 0;
@@ -0,0 +1,180 @@
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <format>
+#include <new>
+
+//* asking the allocator for a block's size keeps untracked allocations free of any overhead,
+//* platforms without such a call fall back to storing the size in front of the block
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define REIC_BLOCK_SIZE(ptr) malloc_size(ptr)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define REIC_BLOCK_SIZE(ptr) _msize(ptr)
+#elif defined(__GLIBC__) || defined(__ANDROID__)
+#include <malloc.h>
+#define REIC_BLOCK_SIZE(ptr) malloc_usable_size(ptr)
+#elif defined(__FreeBSD__)
+#include <malloc_np.h>
+#define REIC_BLOCK_SIZE(ptr) malloc_usable_size(ptr)
+#endif
+
+namespace {
+
+std::atomic<bool> trackingEnabled{false};
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> allocatedBytes{0};
+std::atomic<long long> liveBytes{0};
+std::atomic<long long> peakLiveBytes{0};
+
+#ifdef REIC_BLOCK_SIZE
+constexpr size_t HEADER_SIZE = 0;
+#else
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+#endif
+
+// the size every column of the report counts, the usable size or, with a header, the requested one
+size_t blockSize(void* ptr) {
+#ifdef REIC_BLOCK_SIZE
+    return REIC_BLOCK_SIZE(ptr);
+#else
+    return *reinterpret_cast<size_t*>(static_cast<char*>(ptr) - HEADER_SIZE);
+#endif
+}
+
+// live bytes are signed since blocks allocated before enable() may be freed afterwards
+void* trackedAlloc(size_t size) {
+    auto block = static_cast<char*>(std::malloc(HEADER_SIZE + (size ? size : 1)));
+    if (!block)
+        return nullptr;
+#ifndef REIC_BLOCK_SIZE
+    *reinterpret_cast<size_t*>(block) = size;
+#endif
+
+    void* ptr = block + HEADER_SIZE;
+    if (trackingEnabled.load(std::memory_order_relaxed)) {
+        size_t bytes = blockSize(ptr);
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        long long live = liveBytes.fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed) + static_cast<long long>(bytes);
+        long long peak = peakLiveBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+    return ptr;
+}
+
+void trackedFree(void* ptr) {
+    if (!ptr)
+        return;
+    if (trackingEnabled.load(std::memory_order_relaxed))
+        liveBytes.fetch_sub(static_cast<long long>(blockSize(ptr)), std::memory_order_relaxed);
+    std::free(static_cast<char*>(ptr) - HEADER_SIZE);
+}
+
+std::string formatBytes(double bytes) {
+    const char* units[] = { "B", "KiB", "MiB", "GiB" };
+    size_t unit = 0;
+    while (bytes >= 1024.0 && unit < 3) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    return unit == 0 ? std::format("{:.0f} {}", bytes, units[unit]) : std::format("{:.2f} {}", bytes, units[unit]);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* ptr = trackedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* ptr = trackedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+void MemoryTracker::enable() {
+    trackingEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool MemoryTracker::isEnabled() {
+    return trackingEnabled.load(std::memory_order_relaxed);
+}
+
+MemoryStats MemoryTracker::snapshot() {
+    return {
+        allocationCount.load(std::memory_order_relaxed),
+        allocatedBytes.load(std::memory_order_relaxed),
+        static_cast<size_t>(std::max(0LL, liveBytes.load(std::memory_order_relaxed))),
+        static_cast<size_t>(std::max(0LL, peakLiveBytes.load(std::memory_order_relaxed)))
+    };
+}
+
+void MemoryTracker::resetPeak() {
+    peakLiveBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// takes views so the caller has no temporary strings that would be freed inside the phase
+void MemoryReport::begin(std::string_view name, std::string_view subsystem) {
+    phases.push_back({ std::string(name), std::string(subsystem), 0, 0, 0, 0 });
+    MemoryTracker::resetPeak();
+    start = MemoryTracker::snapshot();
+}
+
+void MemoryReport::end() {
+    if (phases.empty())
+        return;
+
+    MemoryStats now = MemoryTracker::snapshot();
+    MemoryPhase& phase = phases.back();
+    phase.allocations = now.allocations - start.allocations;
+    phase.bytesAllocated = now.bytesAllocated - start.bytesAllocated;
+    phase.peakLiveBytes = now.peakLiveBytes;
+    phase.retainedBytes = static_cast<long long>(now.liveBytes) - static_cast<long long>(start.liveBytes);
+}
+
+void MemoryReport::print(std::ostream& out) const {
+    out << "Memory report:" << std::endl;
+    out << std::format("  {:<10}{:>14}{:>16}{:>16}", "phase", "allocations", "allocated", "peak live") << std::endl;
+    for (const auto& phase : phases) {
+        out << std::format("  {:<10}{:>14}{:>16}{:>16}", phase.name, phase.allocations,
+                           formatBytes(phase.bytesAllocated), formatBytes(phase.peakLiveBytes)) << std::endl;
+    }
+
+    size_t allocations = 0;
+    size_t bytesAllocated = 0;
+    size_t peakLiveBytes = 0;
+    for (const auto& phase : phases) {
+        allocations += phase.allocations;
+        bytesAllocated += phase.bytesAllocated;
+        peakLiveBytes = std::max(peakLiveBytes, phase.peakLiveBytes);
+    }
+    out << std::format("  {:<10}{:>14}{:>16}{:>16}", "total", allocations,
+                       formatBytes(bytesAllocated), formatBytes(peakLiveBytes)) << std::endl;
+
+    //* bytes each phase left alive, i.e. what its data structures keep holding afterwards
+    out << "Retained by subsystem:" << std::endl;
+    for (const auto& phase : phases) {
+        std::string retained = phase.retainedBytes < 0 ? "-" + formatBytes(-phase.retainedBytes) : formatBytes(phase.retainedBytes);
+        out << std::format("  {:<26}{:>16}", phase.subsystem, retained) << std::endl;
+    }
+}
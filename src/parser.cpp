@@ -2,8 +2,14 @@
 #include <iostream>
 #include <string>
 
-Parser::Parser(const std::vector<Token>& tokens, const std::string& fileName, const std::string& content)
-    : tokens(tokens), currentFileName(fileName), fileContent(content), pos(0) {}
+Parser::Parser(const std::vector<Token>& tokens, const std::string& fileName, const std::string& content, size_t firstLine,
+               bool exitOnError)
+    : tokens(tokens), currentFileName(fileName), fileContent(content), pos(0), firstLine(firstLine), exitOnError(exitOnError),
+      failed(false) {}
+
+bool Parser::hasFailed() const {
+    return failed;
+}
 
 Token Parser::peek(int offset = 0, bool skipWhitespace = true) {
     if (skipWhitespace) {
@@ -30,6 +36,10 @@ Token Parser::advance(bool skipWhitespace = true) {
 }
 
 void Parser::handleSyntaxError(const Token& current) {
+    //* only the first error is reported, the enclosing rules unwinding after it would report it again
+    if (failed)
+        return;
+
     std::vector<std::string> lines;
     size_t start = 0;
     size_t end = fileContent.find('\n');
@@ -40,7 +50,7 @@ void Parser::handleSyntaxError(const Token& current) {
     }
     lines.push_back(fileContent.substr(start));
 
-    std::string line = lines[current.lineNumber - 1];
+    std::string line = lines[current.lineNumber - firstLine];
 
     size_t lineStart = line.rfind('\n', current.columnNumber - 2);
     if (lineStart == std::string::npos || lineStart < 1)
@@ -70,26 +80,37 @@ void Parser::handleSyntaxError(const Token& current) {
     if (current.type == TokenType::PAREN_OPEN && peek(-2).type == TokenType::KEYWORD)
         std::cerr << "[info]: The \"" << peek(-2).value << "\" keyword should be used WITHOUT parentheses." << std::endl;
 
-    exit(1);
+    if (exitOnError)
+        exit(1);
+
+    //* skip the remaining tokens so every rule unwinds and parse() returns
+    failed = true;
+    pos = tokens.size();
+}
+
+template <typename T>
+static std::unique_ptr<T> withLine(std::unique_ptr<T> node, size_t lineNumber) {
+    node->lineNumber = lineNumber;
+    return node;
 }
 
 std::unique_ptr<ASTNode> Parser::parseFactor() {
     Token current = advance();
     if (current.type == TokenType::NUMBER)
-        return std::make_unique<NumberNode>(std::stoi(current.value));
+        return withLine(std::make_unique<NumberNode>(std::stoi(current.value)), current.lineNumber);
     else if (current.type == TokenType::STRING)
-        return std::make_unique<StringNode>(current.value);
+        return withLine(std::make_unique<StringNode>(current.value), current.lineNumber);
     else if (current.type == TokenType::IDENTIFIER)
-        return std::make_unique<IdentifierNode>(current.value);
+        return withLine(std::make_unique<IdentifierNode>(current.value), current.lineNumber);
     else if (current.type == TokenType::NEWLINE || current.type == TokenType::END_OF_FILE || current.type == TokenType::WHITESPACE)
         return nullptr;
     else if (current.type == TokenType::KEYWORD) {
         // todo: maybe add support for keywords like if and while
         if (peek(0, false).type != TokenType::WHITESPACE) {
             handleSyntaxError(current);
-            return nullptr; //! Unreachable
+            return nullptr; //! Unreachable with exitOnError
         }
-        return std::make_unique<KeywordNode>(current.value);
+        return withLine(std::make_unique<KeywordNode>(current.value), current.lineNumber);
     } else if (current.type == TokenType::PAREN_OPEN) {
         auto node = parseExpression();
         if (peek().type == TokenType::PAREN_CLOSE) {
@@ -97,48 +118,66 @@ std::unique_ptr<ASTNode> Parser::parseFactor() {
             return node;
         } else {
             handleSyntaxError(current);
-            return nullptr; //! Unreachable
+            return nullptr; //! Unreachable with exitOnError
         }
     } else if (current.type == TokenType::PAREN_CLOSE) {
         handleSyntaxError(current);
-        return nullptr; //! Unreachable
+        return nullptr; //! Unreachable with exitOnError
     } else {
         handleSyntaxError(current);
-        return nullptr; //! Unreachable
+        return nullptr; //! Unreachable with exitOnError
     }
 }
 
 std::unique_ptr<ASTNode> Parser::parseTerm() {
     auto node = parseFactor();
+    std::unique_ptr<BinaryOpNode> chain;
     while (peek().value == "*" || peek().value == "/") {
-        std::string op = advance().value;
+        Token opToken = advance();
         auto right = parseFactor();
-        node = std::make_unique<BinaryOpNode>(std::move(node), op, std::move(right));
+        if (chain) {
+            chain->append(opToken.value, std::move(right));
+        } else {
+            size_t lineNumber = node ? node->lineNumber : opToken.lineNumber;
+            chain = withLine(std::make_unique<BinaryOpNode>(std::move(node), opToken.value, std::move(right)), lineNumber);
+        }
     }
+    if (chain)
+        return chain;
     return node;
 }
 
 std::unique_ptr<ASTNode> Parser::parseExpression() {
     auto node = parseTerm();
+    std::unique_ptr<BinaryOpNode> chain;
     while (peek().value == "+" || peek().value == "-") {
-        std::string op = advance().value;
+        Token opToken = advance();
         auto right = parseTerm();
-        node = std::make_unique<BinaryOpNode>(std::move(node), op, std::move(right));
+        if (chain) {
+            chain->append(opToken.value, std::move(right));
+        } else {
+            size_t lineNumber = node ? node->lineNumber : opToken.lineNumber;
+            chain = withLine(std::make_unique<BinaryOpNode>(std::move(node), opToken.value, std::move(right)), lineNumber);
+        }
     }
+    if (chain)
+        return chain;
     return node;
 }
 
 // parse assignments like x = 10 + 20
 std::unique_ptr<ASTNode> Parser::parseAssignment() {
     if (peek().type == TokenType::IDENTIFIER && peek(1).value == "=") {
-        std::string varName = advance().value;
+        Token varToken = advance();
         advance();
         auto value = parseExpression();
-        if (!value) { 
+        if (!value) {
+            if (failed)
+                return nullptr;
             std::cerr << "[warn]: Assignment value is null at line " << peek().lineNumber << std::endl;
             return nullptr;
         }
-        return std::make_unique<AssignmentNode>(varName, std::move(value));
+        return withLine(std::make_unique<AssignmentNode>(varToken.value, std::move(value)), varToken.lineNumber);
     }
     return parseExpression();
 }
@@ -0,0 +1,179 @@
+#include "pipeline.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+StreamingPipeline::StreamingPipeline(const std::string& inputFileName, ProfileMode profileMode, const std::string& sourceFileName)
+    : inputFileName(inputFileName), codeGen({}, profileMode, sourceFileName), textQueue(STREAM_QUEUE_CAPACITY),
+      tokenQueue(STREAM_QUEUE_CAPACITY), nodeQueue(STREAM_QUEUE_CAPACITY), readFailed(false), parseFailed(false), statements(0) {}
+
+size_t StreamingPipeline::statementCount() const {
+    return statements;
+}
+
+void StreamingPipeline::readStage() {
+    std::ifstream file(inputFileName, std::ios::binary);
+    if (!file) {
+        readFailed = true;
+        textQueue.close();
+        return;
+    }
+
+    std::vector<char> block(STREAM_BATCH_BYTES);
+    std::string buffer;
+    size_t scanned = 0;
+    size_t splitPoint = 0;
+    bool inString = false;
+    size_t firstLine = 1;
+
+    while (file) {
+        file.read(block.data(), block.size());
+        buffer.append(block.data(), file.gcount());
+
+        //* a batch may only end after a newline that is not inside a string literal
+        for (; scanned < buffer.size(); ++scanned) {
+            if (buffer[scanned] == '"')
+                inString = !inString;
+            else if (buffer[scanned] == '\n' && !inString)
+                splitPoint = scanned + 1;
+        }
+
+        if (splitPoint > 0) {
+            std::string text = buffer.substr(0, splitPoint);
+            buffer.erase(0, splitPoint);
+            scanned -= splitPoint;
+            splitPoint = 0;
+
+            size_t lines = std::count(text.begin(), text.end(), '\n');
+            if (!textQueue.push({ std::move(text), firstLine }))
+                return;
+            firstLine += lines;
+        }
+    }
+
+    if (file.bad()) {
+        readFailed = true;
+    } else if (!buffer.empty()) {
+        //* same as the regular reader, the last line always ends with a newline
+        if (buffer.back() != '\n')
+            buffer += '\n';
+        textQueue.push({ std::move(buffer), firstLine });
+    }
+    textQueue.close();
+}
+
+void StreamingPipeline::lexStage() {
+    TextBatch batch;
+    while (textQueue.pop(batch)) {
+        Lexer lexer(batch.text, batch.firstLine);
+        auto tokens = lexer.tokenize();
+        if (!tokenQueue.push({ std::move(tokens), std::move(batch.text), batch.firstLine }))
+            return;
+    }
+    tokenQueue.close();
+}
+
+void StreamingPipeline::parseStage() {
+    TokenBatch batch;
+    while (tokenQueue.pop(batch)) {
+        Parser parser(batch.tokens, inputFileName, batch.text, batch.firstLine, false);
+        auto nodes = parser.parse();
+        if (parser.hasFailed()) {
+            //* the error is already reported, stop the earlier stages and let the emitter finish
+            parseFailed = true;
+            tokenQueue.close();
+            textQueue.close();
+            break;
+        }
+        nodeQueue.push(std::move(nodes));
+    }
+    nodeQueue.close();
+}
+
+bool StreamingPipeline::run(const std::string& outputFileName) {
+    //* includes are only known at the end, so statements go to a side file first
+    std::string bodyFileName = outputFileName + ".body";
+    std::ofstream body(bodyFileName);
+    if (!body) {
+        std::cerr << "[error]: Error opening output file: " << bodyFileName << std::endl;
+        return false;
+    }
+
+    std::thread reader(&StreamingPipeline::readStage, this);
+    std::thread lexer(&StreamingPipeline::lexStage, this);
+    std::thread parser(&StreamingPipeline::parseStage, this);
+
+    NodeBatch batch;
+    size_t bodyLines = 0;
+    while (nodeQueue.pop(batch)) {
+        statements += batch.size();
+        checker.check(batch);
+        //* keep draining the queues after an error so every batch is still checked
+        if (!checker.getErrors().empty())
+            continue;
+        for (const auto& line : codeGen.generateBatch(std::move(batch), false)) {
+            body << line << '\n';
+            bodyLines++;
+        }
+    }
+    checker.finish();
+    if (checker.getErrors().empty()) {
+        for (const auto& line : codeGen.generateBatch({}, true)) {
+            body << line << '\n';
+            bodyLines++;
+        }
+    }
+
+    reader.join();
+    lexer.join();
+    parser.join();
+    body.close();
+
+    if (parseFailed) {
+        std::filesystem::remove(bodyFileName);
+        return false;
+    }
+    if (readFailed) {
+        std::filesystem::remove(bodyFileName);
+        std::cerr << "[error]: Error reading file: " << inputFileName << std::endl;
+        return false;
+    }
+    if (statements == 0) {
+        std::filesystem::remove(bodyFileName);
+        std::cerr << "[error]: Failed to create AST." << std::endl;
+        return false;
+    }
+    if (!checker.getErrors().empty()) {
+        std::filesystem::remove(bodyFileName);
+        SemanticChecker::printErrors(checker.getErrors(), inputFileName, std::cerr);
+        SemanticChecker::printSummary(checker.getErrors().size(), std::cerr);
+        return false;
+    }
+
+    std::ofstream output(outputFileName);
+    if (!output) {
+        std::filesystem::remove(bodyFileName);
+        std::cerr << "[error]: Error opening output file: " << outputFileName << std::endl;
+        return false;
+    }
+
+    auto header = codeGen.generateHeader();
+    for (const auto& line : header) {
+        output << line << '\n';
+    }
+    std::ifstream bodyInput(bodyFileName);
+    if (bodyInput.peek() != std::ifstream::traits_type::eof()) {
+        output << bodyInput.rdbuf();
+    }
+    bodyInput.close();
+    for (const auto& line : codeGen.generateFooter(header.size() + bodyLines + 1, outputFileName)) {
+        output << line << '\n';
+    }
+    output.close();
+
+    std::filesystem::remove(bodyFileName);
+    return true;
+}
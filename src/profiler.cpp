@@ -0,0 +1,63 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+bool ProfileReport::load(const std::string& path, std::vector<ProfileEntry>& entries) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string header;
+    if (!getline(file, header) || header != "reic-profile 1")
+        return false;
+
+    std::string line;
+    while (getline(file, line)) {
+        if (line.empty())
+            continue;
+        std::istringstream fields(line);
+        ProfileEntry entry;
+        if (!(fields >> entry.lineNumber >> entry.hits >> entry.nanos))
+            return false;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+        return a.lineNumber < b.lineNumber;
+    });
+    return true;
+}
+
+void ProfileReport::print(const std::vector<ProfileEntry>& entries, const std::string& source, std::ostream& out) {
+    std::vector<std::string> lines;
+    std::istringstream stream(source);
+    std::string line;
+    while (getline(stream, line)) {
+        lines.push_back(line);
+    }
+
+    unsigned long long totalNanos = 0;
+    for (const auto& entry : entries) {
+        totalNanos += entry.nanos;
+    }
+
+    //* time columns only make sense for --profile-time builds
+    if (totalNanos > 0) {
+        out << std::format("{:>6}{:>12}{:>12}{:>8}  {}", "line", "hits", "time (ms)", "time %", "source") << std::endl;
+    } else {
+        out << std::format("{:>6}{:>12}  {}", "line", "hits", "source") << std::endl;
+    }
+
+    for (const auto& entry : entries) {
+        std::string text = entry.lineNumber >= 1 && entry.lineNumber <= lines.size() ? lines[entry.lineNumber - 1] : "";
+        if (totalNanos > 0) {
+            double percent = 100.0 * static_cast<double>(entry.nanos) / static_cast<double>(totalNanos);
+            out << std::format("{:>6}{:>12}{:>12.3f}{:>7.1f}%  {}", entry.lineNumber, entry.hits,
+                               static_cast<double>(entry.nanos) / 1e6, percent, text) << std::endl;
+        } else {
+            out << std::format("{:>6}{:>12}  {}", entry.lineNumber, entry.hits, text) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include "semantic_checker.hpp"
+#include <format>
+
+void SemanticChecker::error(size_t lineNumber, const std::string& message) {
+    errors.push_back({ lineNumber, message });
+}
+
+const std::vector<SemanticError>& SemanticChecker::getErrors() const {
+    return errors;
+}
+
+void SemanticChecker::check(const std::vector<std::unique_ptr<ASTNode>>& nodes) {
+    for (const auto& node : nodes) {
+        //* like the code generator, print takes the next top-level node as its argument
+        if (expectPrintArgument) {
+            expectPrintArgument = false;
+            checkPrintArgument(node.get());
+        } else {
+            checkStatement(node.get());
+        }
+    }
+}
+
+void SemanticChecker::finish() {
+    if (expectPrintArgument) {
+        expectPrintArgument = false;
+        error(printLineNumber, "Missing argument for print statement");
+    }
+}
+
+void SemanticChecker::checkStatement(const ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ASSIGNMENT: {
+            auto assignNode = static_cast<const AssignmentNode*>(node);
+            std::string valueType = checkExpression(assignNode->value.get(), node->lineNumber);
+
+            auto it = variableTypes.find(assignNode->variable);
+            if (it == variableTypes.end()) {
+                //* still declare it on errors, so later uses do not report it as undeclared again
+                variableTypes[assignNode->variable] = valueType.empty() ? "int" : valueType;
+            } else if (!valueType.empty() && valueType != it->second) {
+                error(node->lineNumber, std::format("Cannot assign a value of type '{}' to '{}' of type '{}'", valueType, assignNode->variable, it->second));
+            }
+            break;
+        }
+        case NodeType::KEYWORD: {
+            auto keywordNode = static_cast<const KeywordNode*>(node);
+            if (keywordNode->name == "print") {
+                expectPrintArgument = true;
+                printLineNumber = node->lineNumber;
+            } else {
+                error(node->lineNumber, std::format("Unsupported keyword '{}'", keywordNode->name));
+            }
+            break;
+        }
+        default:
+            checkExpression(node, node->lineNumber);
+            error(node->lineNumber, "Expression result is not used, did you mean to print it?");
+            break;
+    }
+}
+
+void SemanticChecker::checkPrintArgument(const ASTNode* node) {
+    switch (node->type) {
+        case NodeType::STRING:
+        case NodeType::NUMBER:
+        case NodeType::IDENTIFIER:
+        case NodeType::BINARY_OP:
+            checkExpression(node, printLineNumber);
+            break;
+        default:
+            error(node->lineNumber ? node->lineNumber : printLineNumber, std::format("Cannot print {} node", node->getType()));
+            break;
+    }
+}
+
+// returns the C type of the expression, or an empty string if it already reported an error
+std::string SemanticChecker::checkExpression(const ASTNode* node, size_t lineNumber) {
+    if (!node) {
+        error(lineNumber, "Incomplete expression");
+        return "";
+    }
+    if (node->lineNumber) {
+        lineNumber = node->lineNumber;
+    }
+
+    switch (node->type) {
+        case NodeType::STRING:
+            return "char*";
+        case NodeType::NUMBER:
+            return "int";
+        case NodeType::IDENTIFIER: {
+            auto name = static_cast<const IdentifierNode*>(node)->name;
+            auto it = variableTypes.find(name);
+            if (it == variableTypes.end()) {
+                error(lineNumber, std::format("Use of undeclared variable '{}'", name));
+                return "";
+            }
+            return it->second;
+        }
+        case NodeType::BINARY_OP: {
+            auto binaryNode = static_cast<const BinaryOpNode*>(node);
+            bool valid = true;
+            for (const auto& operand : binaryNode->operands) {
+                std::string operandType = checkExpression(operand.get(), lineNumber);
+                if (operandType == "char*") {
+                    error(lineNumber, "Strings cannot be used in arithmetic expressions");
+                }
+                valid = valid && operandType == "int";
+            }
+            return valid ? "int" : "";
+        }
+        case NodeType::KEYWORD:
+            error(lineNumber, std::format("Unexpected keyword '{}' in expression", static_cast<const KeywordNode*>(node)->name));
+            return "";
+        case NodeType::ASSIGNMENT:
+            error(lineNumber, "Assignments cannot be used as expressions");
+            return "";
+    }
+    return "";
+}
+
+void SemanticChecker::printErrors(const std::vector<SemanticError>& errors, const std::string& fileName, std::ostream& out) {
+    for (const auto& error : errors) {
+        out << std::format("[error]: {}:{}: {}", fileName, error.lineNumber, error.message) << std::endl;
+    }
+}
+
+void SemanticChecker::printSummary(size_t errorCount, std::ostream& out) {
+    out << std::format("[error]: {} error{} found, no output written.", errorCount, errorCount == 1 ? "" : "s") << std::endl;
+}
@@ -0,0 +1,102 @@
+#include "unity_builder.hpp"
+#include "code_generator.hpp"
+#include <algorithm>
+#include <cctype>
+
+UnityBuilder::UnityBuilder(bool lineDirectives) : lineDirectives(lineDirectives) {}
+
+std::string UnityBuilder::functionNameFor(const std::string& name) {
+    std::string functionName = "reic_script_";
+    for (unsigned char c : name) {
+        functionName += std::isalnum(c) ? static_cast<char>(c) : '_';
+    }
+    return functionName;
+}
+
+void UnityBuilder::addInclude(const std::string& include) {
+    if (std::find(includes.begin(), includes.end(), include) == includes.end()) {
+        includes.push_back(include);
+    }
+}
+
+bool UnityBuilder::addScript(const std::string& name, std::vector<std::unique_ptr<ASTNode>>&& nodes, const std::string& sourceFileName) {
+    std::string functionName = functionNameFor(name);
+    if (std::find(names.begin(), names.end(), name) != names.end()
+        || std::find(functionNames.begin(), functionNames.end(), functionName) != functionNames.end()) {
+        return false;
+    }
+
+    //* every script gets its own generator, so variables never leak between scripts
+    CodeGenerator codeGen(std::move(nodes), ProfileMode::OFF, lineDirectives ? sourceFileName : "", functionName);
+    auto function = codeGen.generateFunction();
+    for (const auto& include : codeGen.getIncludes()) {
+        addInclude(include);
+    }
+
+    functions.push_back(std::move(function));
+    footer = codeGen.generateFooter();
+    names.push_back(name);
+    functionNames.push_back(functionName);
+    return true;
+}
+
+std::vector<std::string> UnityBuilder::generateCode(const std::string& outputFileName) const {
+    std::vector<std::string> code;
+    std::vector<std::string> allIncludes = includes;
+    for (const std::string include : { "<stdio.h>", "<string.h>" }) {
+        if (std::find(allIncludes.begin(), allIncludes.end(), include) == allIncludes.end()) {
+            allIncludes.push_back(include);
+        }
+    }
+
+    for (const auto& include : allIncludes) {
+        code.push_back("#include " + include);
+    }
+    code.push_back("");
+
+    for (const auto& function : functions) {
+        code.insert(code.end(), function.begin(), function.end());
+        //* the footer, the next function and the dispatcher are generated code, not part of this script
+        if (lineDirectives) {
+            code.push_back(CodeGenerator::lineDirective(code.size() + 2, outputFileName));
+        }
+        code.insert(code.end(), footer.begin(), footer.end());
+        code.push_back("");
+    }
+
+    code.push_back("static const char* reic_script_names[] = {");
+    for (const auto& name : names) {
+        std::string escaped;
+        for (char c : name) {
+            if (c == '\\' || c == '"') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        code.push_back("    \"" + escaped + "\",");
+    }
+    code.push_back("};");
+    code.push_back("");
+
+    code.push_back("static int (*const reic_script_functions[])(void) = {");
+    for (const auto& functionName : functionNames) {
+        code.push_back("    " + functionName + ",");
+    }
+    code.push_back("};");
+    code.push_back("");
+
+    code.push_back("int main(int argc, char** argv) {");
+    code.push_back("    unsigned long count = sizeof(reic_script_names) / sizeof(reic_script_names[0]);");
+    code.push_back("    if (argc > 1) {");
+    code.push_back("        for (unsigned long i = 0; i < count; ++i) {");
+    code.push_back("            if (strcmp(argv[1], reic_script_names[i]) == 0) return reic_script_functions[i]();");
+    code.push_back("        }");
+    code.push_back("        fprintf(stderr, \"unknown script: %s\\n\", argv[1]);");
+    code.push_back("    }");
+    code.push_back("    fprintf(stderr, \"usage: %s <script>\\nscripts:\\n\", argv[0]);");
+    code.push_back("    for (unsigned long i = 0; i < count; ++i) fprintf(stderr, \"  %s\\n\", reic_script_names[i]);");
+    code.push_back("    return 1;");
+    code.push_back("}");
+
+    return code;
+}